@@ -0,0 +1,300 @@
+/**
+ * @file track_benchmark.cpp
+ * @brief 軌道計算的效能測試
+ * @details
+ * 不需要Qt或OpenGL，只連結軌道計算的程式（ParamEquation、ArcLenAccum、TrackCurve、FrameTable、TrainFleet、TrackIO）。
+ *
+ * 對每種 SplineType、每個控制點個數（4 ~ 1M），測量：
+ * |benchmark           |每次操作                                                        |
+ * |---                 |---                                                             |
+ * |make_param          |對每段曲線用 Draw::make_* 建立參數式，並在 Eval_Samples 個t上求值 |
+ * |evaluate_segments   |同上，但用 Draw::evaluate_segments 批次求值                       |
+ * |rebuild             |整個重建曲線長累積表（TrainSystem::update_arc_len_accum）         |
+ * |update_control_point|拖移一個控制點後只重算附近的曲線                                  |
+ * |T_to_S, S_to_T      |一次查表                                                         |
+ * |frames_rebuild      |重建 FrameTable                                                  |
+ * |cart_placement      |火車前進一步，並用 FrameTable::at_chain 查出每節車廂的位置和方向     |
+ * |import_text         |從記憶體中的文字格式讀入控制點（TrackIO::parse_text）              |
+ * |import_binary       |從記憶體中的二進位格式（含曲線長累積表）讀入並重建曲線               |
+ *
+ * 結果輸出到stdout，每個benchmark一行，格式為CSV（預設）或JSON。
+ *
+ * 用法：`track_benchmark [--max-cp N] [--min-time SEC] [--format csv|json]`
+ */
+#include "TrackCurve.h"
+#include "FrameTable.h"
+#include "TrainFleet.h"
+#include "TrackIO.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float Tension = 0.5f;       ///< 同 TrainSystem 的預設值
+constexpr float Tolerance = 1.e-3f;   ///< 同 TrainSystem 的預設值
+constexpr float Cp_Spacing = 1.f;     ///< 相鄰控制點的距離
+constexpr float Frame_Interval = 0.05f;
+constexpr size_t Max_Frames = 1 << 20; ///< 很長的軌道放大 FrameTable 的間隔，避免用掉太多記憶體
+constexpr size_t Eval_Samples = 16;
+constexpr size_t Query_Num = 1 << 16;
+constexpr int Train_Num = 16;
+constexpr int Cart_Num = 8;
+
+const size_t Cp_Nums[] = { 4, 64, 1024, 16384, 262144, 1048576 };
+const SplineType Spline_Types[] = { SplineType::LINEAR, SplineType::CARDINAL, SplineType::CUBIC_B };
+
+/// 避免被編譯器最佳化掉
+volatile float g_sink;
+
+struct Options {
+    size_t max_cp = 1048576;
+    double min_time = 0.2; ///< 每個benchmark至少跑幾秒
+    bool json = false;
+};
+
+const char* spline_name(SplineType type)
+{
+    switch (type) {
+    case SplineType::LINEAR: return "linear";
+    case SplineType::CARDINAL: return "cardinal";
+    case SplineType::CUBIC_B: return "cubic_b";
+    }
+    return "?";
+}
+
+/// 繞一圈、上下起伏的軌道，相鄰控制點相距約 Cp_Spacing
+std::vector<ControlPoint> make_track(size_t n)
+{
+    const float radius = std::max(2.f, n * Cp_Spacing / 6.2831853f);
+    std::mt19937 rng(static_cast<unsigned>(n));
+    std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+
+    std::vector<ControlPoint> control_points(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float theta = 6.2831853f * i / n;
+        control_points[i].pos = glm::vec3(radius * std::cos(theta) + jitter(rng),
+                                          2.f + std::sin(8 * theta) + jitter(rng),
+                                          radius * std::sin(theta) + jitter(rng));
+        control_points[i].orient = glm::vec3(jitter(rng), 1, jitter(rng));
+    }
+    return control_points;
+}
+
+class Reporter
+{
+    bool m_json;
+    bool m_first;
+
+public:
+    explicit Reporter(bool json) : m_json(json), m_first(true)
+    {
+        if (m_json)
+            std::printf("[\n");
+        else
+            std::printf("benchmark,spline,cp_num,iterations,ns_per_op\n");
+    }
+
+    ~Reporter()
+    {
+        if (m_json)
+            std::printf("\n]\n");
+    }
+
+    void report(const char* name, const char* spline, size_t cp_num, size_t iterations, double ns_per_op)
+    {
+        if (m_json) {
+            std::printf("%s  {\"benchmark\": \"%s\", \"spline\": \"%s\", \"cp_num\": %zu, \"iterations\": %zu, \"ns_per_op\": %.3f}",
+                        m_first ? "" : ",\n", name, spline, cp_num, iterations, ns_per_op);
+        }
+        else {
+            std::printf("%s,%s,%zu,%zu,%.3f\n", name, spline, cp_num, iterations, ns_per_op);
+        }
+        m_first = false;
+        std::fflush(stdout);
+    }
+};
+
+/**
+ * @brief 重複執行 f 直到總時間超過 min_time（至少一次），回報每次操作的平均時間
+ * @param ops_per_call - 每呼叫一次 f 做了幾次操作
+ */
+template <class F>
+void run(Reporter& reporter, const Options& opt, const char* name, const char* spline, size_t cp_num,
+         size_t ops_per_call, F f)
+{
+    size_t calls = 0;
+    const Clock::time_point start = Clock::now();
+    double elapsed = 0;
+    do {
+        f();
+        ++calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < opt.min_time);
+
+    const size_t ops = calls * ops_per_call;
+    reporter.report(name, spline, cp_num, ops, elapsed * 1e9 / ops);
+}
+
+Draw::Param_Equation make_param(SplineType type, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3)
+{
+    switch (type) {
+    case SplineType::LINEAR: return Draw::make_line(p1, p2);
+    case SplineType::CARDINAL: return Draw::make_cardinal(p0, p1, p2, p3, Tension);
+    case SplineType::CUBIC_B: return Draw::make_cubic_b_spline(p0, p1, p2, p3);
+    }
+    return Draw::make_line(p1, p2);
+}
+
+void bench_spline(Reporter& reporter, const Options& opt, SplineType type, size_t n)
+{
+    const char* spline = spline_name(type);
+    std::vector<ControlPoint> control_points = make_track(n);
+    auto cp = [&](size_t i) { return control_points[i % n].pos; };
+
+    float t[Eval_Samples];
+    for (size_t k = 0; k < Eval_Samples; ++k)
+        t[k] = float(k) / Eval_Samples;
+
+    run(reporter, opt, "make_param", spline, n, n * Eval_Samples, [&] {
+        float sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const Draw::Param_Equation eq = make_param(type, cp(i + n - 1), cp(i), cp(i + 1), cp(i + 2));
+            for (float tk : t)
+                sum += eq(tk).y;
+        }
+        g_sink = sum;
+    });
+
+    TrackCurve track;
+    track.rebuild(control_points, type, Tension, Tolerance);
+
+    Draw::Points_SoA points;
+    run(reporter, opt, "evaluate_segments", spline, n, n * Eval_Samples, [&] {
+        Draw::evaluate_segments(track.pos_segments().data(), track.segment_num(), t, Eval_Samples, points);
+        g_sink = points.y[points.size() / 2];
+    });
+
+    run(reporter, opt, "rebuild", spline, n, 1, [&] {
+        track.rebuild(control_points, type, Tension, Tolerance);
+        g_sink = track.length();
+    });
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    run(reporter, opt, "update_control_point", spline, n, 1, [&] {
+        const size_t i = pick(rng);
+        control_points[i].pos.y += 0.01f;
+        track.update_control_point(control_points, i, type, Tension, Tolerance);
+        g_sink = track.length();
+    });
+
+    std::uniform_real_distribution<float> T_dist(0, track.arc_len_accum().max_T());
+    std::uniform_real_distribution<float> S_dist(0, track.length());
+    std::vector<float> Ts(Query_Num), Ss(Query_Num);
+    for (size_t k = 0; k < Query_Num; ++k) {
+        Ts[k] = T_dist(rng);
+        Ss[k] = S_dist(rng);
+    }
+    run(reporter, opt, "T_to_S", spline, n, Query_Num, [&] {
+        float sum = 0;
+        for (float T : Ts)
+            sum += track.T_to_S(T);
+        g_sink = sum;
+    });
+    run(reporter, opt, "S_to_T", spline, n, Query_Num, [&] {
+        float sum = 0;
+        for (float S : Ss)
+            sum += track.S_to_T(S);
+        g_sink = sum;
+    });
+
+    FrameTable frames(std::max(Frame_Interval, track.length() / Max_Frames));
+    run(reporter, opt, "frames_rebuild", spline, n, 1, [&] {
+        frames.rebuild(track);
+        g_sink = frames.length();
+    });
+
+    TrainFleet fleet(Cp_Spacing, Cp_Spacing);
+    for (int k = 0; k < Train_Num; ++k)
+        fleet.add(frames.length() * k / Train_Num, 1.f, Cart_Num);
+    std::vector<float> offsets(Cart_Num + 1);
+    for (int i = 0; i <= Cart_Num; ++i)
+        offsets[i] = i * fleet.cart_spacing();
+    std::vector<FrameTable::Frame> cart_frames(offsets.size());
+    run(reporter, opt, "cart_placement", spline, n, size_t(Train_Num) * (Cart_Num + 1), [&] {
+        fleet.advance(0.1f, frames.length());
+        float sum = 0;
+        for (size_t k = 0; k < fleet.size(); ++k) {
+            frames.at_chain(fleet.S(k), offsets.data(), offsets.size(), cart_frames.data());
+            for (const FrameTable::Frame& f : cart_frames)
+                sum += f.pos.y + f.TOP.y;
+        }
+        g_sink = sum;
+    });
+
+    std::ostringstream binary;
+    TrackIO::write_binary(binary, control_points, &track.arc_len_accum(), type, Tension, Tolerance);
+    const std::string binary_data = binary.str();
+    run(reporter, opt, "import_binary", spline, n, 1, [&] {
+        TrackIO::Track_Data data = TrackIO::parse_binary(binary_data.data(), binary_data.size());
+        track.rebuild(data.control_points, type, Tension, std::move(data.tables));
+        g_sink = track.length();
+    });
+}
+
+void bench_import_text(Reporter& reporter, const Options& opt, size_t n)
+{
+    std::ostringstream text;
+    TrackIO::write_text(text, make_track(n));
+    const std::string text_data = text.str();
+
+    run(reporter, opt, "import_text", "-", n, 1, [&] {
+        g_sink = TrackIO::parse_text(text_data.data(), text_data.size()).back().pos.y;
+    });
+}
+
+bool parse_options(int argc, char** argv, Options& opt)
+{
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max-cp") == 0 && has_value)
+            opt.max_cp = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--min-time") == 0 && has_value)
+            opt.min_time = std::strtod(argv[++i], nullptr);
+        else if (std::strcmp(argv[i], "--format") == 0 && has_value)
+            opt.json = std::strcmp(argv[++i], "json") == 0;
+        else
+            return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parse_options(argc, argv, opt)) {
+        std::fprintf(stderr, "usage: %s [--max-cp N] [--min-time SEC] [--format csv|json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Reporter reporter(opt.json);
+    for (size_t n : Cp_Nums) {
+        if (n > opt.max_cp)
+            break;
+        bench_import_text(reporter, opt, n);
+        for (SplineType type : Spline_Types)
+            bench_spline(reporter, opt, type, n);
+    }
+    return EXIT_SUCCESS;
+}
@@ -68,6 +68,13 @@ void Box_VAO::draw()
     glBindVertexArray(0);
 }
 
+void Box_VAO::drawInstanced(GLsizei instancecount)
+{
+    glBindVertexArray(m_VAO_id);
+    glDrawArraysInstanced(GL_QUADS, /*first*/0, /*count*/24, instancecount);
+    glBindVertexArray(0);
+}
+
 void Box_VAO::draw_face(FACE face)
 {
     glBindVertexArray(m_VAO_id);
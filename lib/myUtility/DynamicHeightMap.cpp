@@ -8,6 +8,7 @@
 
 DynamicHeightMap::DynamicHeightMap()
     : m_current_frame(0), m_plane_VAO(), m_shader_drop("shader/DHM/simple.vert", nullptr, nullptr, nullptr, "shader/DHM/drop.frag"),
+    m_uniform_center(m_shader_drop.uniform<glm::vec2>("u_center")),
     m_shader_update("shader/DHM/simple.vert", nullptr, nullptr, nullptr, "shader/DHM/update.frag")
 {
     glGenFramebuffers(1, &m_fbo);
@@ -33,11 +34,8 @@ DynamicHeightMap::DynamicHeightMap()
     glBindTexture(GL_TEXTURE_2D, 0);
 
     // set up sampler
-    m_shader_drop.Use();
-    glUniform1i(glGetUniformLocation(m_shader_drop.Program, "u_water"), 1);
-    m_shader_update.Use();
-    glUniform1i(glGetUniformLocation(m_shader_update.Program, "u_water"), 1);
-    glUseProgram(0);
+    m_shader_drop.uniform<GLint>("u_water").set(1);
+    m_shader_update.uniform<GLint>("u_water").set(1);
 }
 
 DynamicHeightMap::~DynamicHeightMap()
@@ -91,8 +89,8 @@ void DynamicHeightMap::add_drop(GLfloat x, GLfloat y)
     glViewport(0, 0, IMG_SIZE, IMG_SIZE);
     m_shader_drop.Use();
     this->bind(1);
-    // call glUniform to pass (x, y)
-    glUniform2f(glGetUniformLocation(m_shader_drop.Program, "u_center"), x, y);
+    // 傳入 (x, y)，和上次一樣時不會重新上傳
+    m_uniform_center.set(glm::vec2(x, y));
     m_plane_VAO.draw();
 
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, old_fbo);
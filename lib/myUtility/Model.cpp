@@ -11,6 +11,15 @@ void Model::draw()
     }
 }
 
+void Model::append_triangles(std::vector<glm::vec3> &triangles) const
+{
+    for (const Mesh& mesh : m_meshes) {
+        const std::vector<Mesh::Vertex>& vertices = mesh.vertices();
+        for (unsigned int index : mesh.indices())
+            triangles.push_back(vertices[index].aPosition);
+    }
+}
+
 void Model::loadModel(const char* path)
 {
     Assimp::Importer importer;
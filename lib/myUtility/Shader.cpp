@@ -3,6 +3,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <glm/gtc/type_ptr.hpp>
 
 Shader::Shader(const GLchar *vert, const GLchar *tesc, const GLchar *tese, const char *geom, const char *frag)
 {
@@ -32,6 +33,19 @@ Shader::Shader(const GLchar *vert, const GLchar *tesc, const GLchar *tese, const
         shaders.push_back(this->compileShader(GL_FRAGMENT_SHADER, frag));
         this->type = (Shader::Type)(this->type | Type::FRAGMENT_SHADER);
     }
+    this->link(shaders);
+}
+
+Shader::Shader(const GLchar *comp)
+{
+    std::vector<GLuint> shaders;
+    shaders.push_back(this->compileShader(GL_COMPUTE_SHADER, comp));
+    this->type = Type::COMPUTE_SHADER;
+    this->link(shaders);
+}
+
+void Shader::link(const std::vector<GLuint> &shaders)
+{
     // Shader Program
     GLint success;
     GLchar infoLog[512];
@@ -55,6 +69,8 @@ Shader::Shader(const GLchar *vert, const GLchar *tesc, const GLchar *tese, const
 
     for (GLuint shader : shaders)
         glDeleteShader(shader);
+
+    this->introspect_uniforms();
 }
 
 void Shader::Use()
@@ -62,6 +78,134 @@ void Shader::Use()
     glUseProgram(this->Program);
 }
 
+void Shader::introspect_uniforms()
+{
+    GLint count = 0, max_name_length = 0;
+    glGetProgramInterfaceiv(this->Program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    glGetProgramInterfaceiv(this->Program, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length);
+
+    std::vector<GLchar> name(max_name_length + 1);
+    const GLenum props[] = { GL_TYPE, GL_LOCATION, GL_BLOCK_INDEX };
+    for (GLint i = 0; i < count; ++i) {
+        GLint values[3];
+        glGetProgramResourceiv(this->Program, GL_UNIFORM, i, 3, props, 3, nullptr, values);
+        // uniform block中的變數沒有location，由UBO設定
+        if (values[2] != -1 || values[1] == -1) continue;
+
+        glGetProgramResourceName(this->Program, GL_UNIFORM, i, static_cast<GLsizei>(name.size()), nullptr, name.data());
+        std::string uniform_name(name.data());
+
+        const int index = static_cast<int>(m_uniforms.size());
+        m_uniforms.push_back(Uniform_Info{ values[1], static_cast<GLenum>(values[0]), {} });
+        m_uniform_index[uniform_name] = index;
+
+        // 陣列的名字為 "name[0]"，也可以用 "name" 查
+        const size_t bracket = uniform_name.find('[');
+        if (bracket != std::string::npos)
+            m_uniform_index[uniform_name.substr(0, bracket)] = index;
+    }
+}
+
+bool Shader::type_matches(GLenum type, const GLint*)
+{
+    // glProgramUniform1i 可以設定int、bool及所有sampler、image
+    switch (type) {
+    case GL_INT: case GL_BOOL:
+    case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_BUFFER:
+    case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+    case GL_IMAGE_1D: case GL_IMAGE_2D: case GL_IMAGE_3D: case GL_IMAGE_CUBE:
+    case GL_IMAGE_1D_ARRAY: case GL_IMAGE_2D_ARRAY: case GL_IMAGE_BUFFER:
+    case GL_INT_IMAGE_2D: case GL_UNSIGNED_INT_IMAGE_2D:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool Shader::type_matches(GLenum type, const GLuint*)
+{
+    return type == GL_UNSIGNED_INT || type == GL_BOOL;
+}
+
+bool Shader::type_matches(GLenum type, const GLfloat*)
+{
+    return type == GL_FLOAT;
+}
+
+bool Shader::type_matches(GLenum type, const glm::vec2*)
+{
+    return type == GL_FLOAT_VEC2;
+}
+
+bool Shader::type_matches(GLenum type, const glm::vec3*)
+{
+    return type == GL_FLOAT_VEC3;
+}
+
+bool Shader::type_matches(GLenum type, const glm::vec4*)
+{
+    return type == GL_FLOAT_VEC4;
+}
+
+bool Shader::type_matches(GLenum type, const glm::ivec2*)
+{
+    return type == GL_INT_VEC2 || type == GL_BOOL_VEC2;
+}
+
+bool Shader::type_matches(GLenum type, const glm::mat4*)
+{
+    return type == GL_FLOAT_MAT4;
+}
+
+void Shader::upload(GLint location, GLint value)
+{
+    glProgramUniform1i(this->Program, location, value);
+}
+
+void Shader::upload(GLint location, GLuint value)
+{
+    glProgramUniform1ui(this->Program, location, value);
+}
+
+void Shader::upload(GLint location, GLfloat value)
+{
+    glProgramUniform1f(this->Program, location, value);
+}
+
+void Shader::upload(GLint location, const glm::vec2 &value)
+{
+    glProgramUniform2fv(this->Program, location, 1, glm::value_ptr(value));
+}
+
+void Shader::upload(GLint location, const glm::vec3 &value)
+{
+    glProgramUniform3fv(this->Program, location, 1, glm::value_ptr(value));
+}
+
+void Shader::upload(GLint location, const glm::vec4 &value)
+{
+    glProgramUniform4fv(this->Program, location, 1, glm::value_ptr(value));
+}
+
+void Shader::upload(GLint location, const glm::ivec2 &value)
+{
+    glProgramUniform2iv(this->Program, location, 1, glm::value_ptr(value));
+}
+
+void Shader::upload(GLint location, const glm::mat4 &value)
+{
+    glProgramUniformMatrix4fv(this->Program, location, 1, false, glm::value_ptr(value));
+}
+
 std::string Shader::readCode(const GLchar *path)
 {
     std::string code;
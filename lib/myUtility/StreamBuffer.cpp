@@ -0,0 +1,100 @@
+#include "StreamBuffer.h"
+#include <stdexcept>
+
+StreamBuffer::StreamBuffer(GLsizeiptr region_size)
+    : m_buffer(0), m_region_size(region_size), m_ptr(nullptr), m_fences{}, m_region(0), m_used(0)
+{
+    this->create();
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    this->destroy();
+}
+
+void StreamBuffer::create()
+{
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr total = Region_Num * m_region_size;
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags);
+    m_ptr = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (!m_ptr)
+        throw std::runtime_error("ERROR::STREAM_BUFFER::MAP_FAILED");
+
+    m_region = 0;
+    m_used = 0;
+}
+
+void StreamBuffer::destroy()
+{
+    for (GLsync& fence : m_fences)
+        wait_and_delete(fence);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+    m_ptr = nullptr;
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    // 對齊的是在整個buffer中的offset
+    auto aligned_offset = [&]() {
+        const GLintptr offset = m_region * m_region_size + m_used;
+        return (offset + alignment - 1) / alignment * alignment;
+    };
+
+    GLintptr offset = aligned_offset();
+    if (offset + size > (m_region + 1) * m_region_size) {
+        this->next_region();
+        offset = aligned_offset();
+        if (offset + size > (m_region + 1) * m_region_size)
+            throw std::runtime_error("ERROR::STREAM_BUFFER::ALLOCATION_TOO_LARGE");
+    }
+
+    m_used = offset + size - m_region * m_region_size;
+    return { m_ptr + offset, offset };
+}
+
+void StreamBuffer::reserve(GLsizeiptr region_size)
+{
+    if (region_size <= m_region_size)
+        return;
+
+    this->destroy();
+    m_region_size = region_size;
+    this->create();
+}
+
+void StreamBuffer::next_region()
+{
+    // 目前區域中的資料只會被到此為止送出的指令使用
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_region = (m_region + 1) % Region_Num;
+    m_used = 0;
+    wait_and_delete(m_fences[m_region]);
+}
+
+void StreamBuffer::wait_and_delete(GLsync &fence)
+{
+    if (!fence)
+        return;
+
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;) {
+        const GLenum result = glClientWaitSync(fence, flags, /*1ms*/1000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+            break;
+        flags = 0; // 只需要flush一次
+    }
+    glDeleteSync(fence);
+    fence = 0;
+}
@@ -31,6 +31,12 @@ public:
     /// @details 畫出方塊的每一面
     void draw() override;
 
+    /**
+     * @brief 用glDrawArraysInstanced繪製
+     * @param instancecount - 幾個實例（instance）
+     */
+    void drawInstanced(GLsizei instancecount);
+
 public:
     enum class FACE {
         NEGATIVE_X = 0,
@@ -15,6 +15,7 @@ private:
     GLuint m_current_frame; //!< 在0,1間來回，目前的幀使用了m_color_texture[m_current_frame]做color buffer
     Plane_VAO m_plane_VAO;
     Shader m_shader_drop;
+    Shader::Uniform<glm::vec2> m_uniform_center; //!< m_shader_drop 的 u_center
     Shader m_shader_update;
 
 public:
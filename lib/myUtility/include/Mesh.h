@@ -76,6 +76,12 @@ public:
     /// 綁定VAO和貼圖並呼叫glDrawElements
     void draw();
 
+    /// 頂點（世界座標）
+    const std::vector<Vertex>& vertices() const { return m_vertices; }
+
+    /// 繪製順序，每3個為一個三角形
+    const std::vector<unsigned int>& indices() const { return m_indices; }
+
 private:
     // mesh data
     std::vector<Vertex>       m_vertices;
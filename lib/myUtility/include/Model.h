@@ -34,6 +34,9 @@ public:
 
     /// 對模型包含的每個Mesh呼叫 Mesh::draw
     void draw();
+
+    /// 將模型的所有三角形（世界座標，每3個點為一個三角形）加到 triangles 後面
+    void append_triangles(std::vector<glm::vec3>& triangles) const;
 private:
     std::vector<Mesh> m_meshes; ///< 每個Mesh
     std::map<std::string, Mesh::Texture> m_loaded_texture; ///!< 記錄已經載入的texture。key: file name，value: texture
@@ -6,12 +6,24 @@
 #define SHADER_H
 
 #include <glad/gl.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <cassert>
+#include <cstring>
 
 
 /**
  * @brief The Shader class
+ * @details
+ * link之後會用 glGetProgramInterfaceiv 列舉所有active uniform並記下位置。
+ * 用 uniform<T>() 取得預先查好的handle後，每次 Uniform::set() 只在值改變時才呼叫 glProgramUniform*，
+ * 不需要先 Use()，也不需要每次用字串查位置。
  */
 class Shader
 {
@@ -23,6 +35,33 @@ public:
         TESS_EVALUATION_SHADER = (1 << 2),
         GEOMETRY_SHADER = (1 << 3),
         FRAGMENT_SHADER = (1 << 4),
+        COMPUTE_SHADER = (1 << 5),
+    };
+
+    /**
+     * @brief 預先查好位置的uniform
+     * @tparam T - GLint（int、bool、sampler）、GLuint、GLfloat、glm::vec2、glm::vec3、glm::vec4、glm::ivec2、glm::mat4
+     * @details
+     * 由 Shader::uniform() 取得。若shader中沒有這個uniform（例如被編譯器最佳化掉），set() 什麼都不做。
+     * handle記住的是Shader的位址，所以Shader不能被複製或移動（copy、move constructor都已刪除）。
+     */
+    template<typename T>
+    class Uniform {
+        friend class Shader;
+        Shader* m_shader;
+        int m_index; ///< 在 Shader::m_uniforms 中的index
+
+        Uniform(Shader* shader, int index) : m_shader(shader), m_index(index) {}
+
+    public:
+        /// 無效的handle
+        Uniform() : m_shader(nullptr), m_index(-1) {}
+
+        /// shader中是否有這個uniform
+        bool valid() const { return m_shader != nullptr; }
+
+        /// 設定值，和上次設定的值一樣時不會呼叫OpenGL
+        void set(const T& value) { if (m_shader) m_shader->set_uniform(m_index, value); }
     };
 
 public:
@@ -41,9 +80,90 @@ public:
      */
     Shader(const GLchar* vert, const GLchar* tesc, const GLchar* tese, const char* geom, const char* frag);
 
+    /**
+     * @brief 在執行時編譯compute shader
+     * @param comp - compute shader的檔名
+     * @throw `std::runtime_error` - 若compile失敗
+     */
+    explicit Shader(const GLchar* comp);
+
+    /// Uniform 記住的是Shader的位址，複製或移動後會指到舊的物件
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader&&) = delete;
+    Shader& operator=(Shader&&) = delete;
+
     /// Uses the current shader
     void Use();
+
+    /**
+     * @brief 取得uniform的handle
+     * @param name - uniform的名字（陣列可用 "name" 或 "name[0]"）
+     * @return 若沒有這個uniform，回傳無效的handle
+     * @note 只在初始化時呼叫，把handle存起來；不要在每個frame中呼叫
+     * @note debug build中，T 和shader中宣告的型別不符時會assert
+     */
+    template<typename T>
+    Uniform<T> uniform(const std::string& name) {
+        auto it = m_uniform_index.find(name);
+        if (it == m_uniform_index.end()) return Uniform<T>();
+        assert(type_matches(m_uniforms[it->second].type, static_cast<const T*>(nullptr)) && "ERROR::SHADER::UNIFORM_TYPE_MISMATCH");
+        return Uniform<T>(this, it->second);
+    }
+
 private:
+    /// 由 glGetProgramInterfaceiv 列舉出的uniform
+    struct Uniform_Info {
+        GLint location; ///< 位置
+        GLenum type;    ///< GL_FLOAT_VEC3 等
+        std::vector<unsigned char> value; ///< 上次上傳的值，空的代表還沒上傳過
+    };
+
+    std::vector<Uniform_Info> m_uniforms; ///< 所有在uniform block外的active uniform
+    std::unordered_map<std::string, int> m_uniform_index; ///< 名字 -> m_uniforms的index
+
+    /// link所有shader成 Program，並列舉所有active uniform
+    void link(const std::vector<GLuint>& shaders);
+
+    /// link後列舉所有active uniform
+    void introspect_uniforms();
+
+    /// @name shader中型別為 type 的uniform 是否可以用對應的 glProgramUniform* 設定（第二個參數只用來選overload）
+    /// @{
+    static bool type_matches(GLenum type, const GLint*);
+    static bool type_matches(GLenum type, const GLuint*);
+    static bool type_matches(GLenum type, const GLfloat*);
+    static bool type_matches(GLenum type, const glm::vec2*);
+    static bool type_matches(GLenum type, const glm::vec3*);
+    static bool type_matches(GLenum type, const glm::vec4*);
+    static bool type_matches(GLenum type, const glm::ivec2*);
+    static bool type_matches(GLenum type, const glm::mat4*);
+    /// @}
+
+    /// 值改變時才上傳
+    template<typename T>
+    void set_uniform(int index, const T& value) {
+        Uniform_Info& info = m_uniforms[index];
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        if (info.value.size() == sizeof(T) && std::memcmp(info.value.data(), bytes, sizeof(T)) == 0)
+            return;
+
+        info.value.assign(bytes, bytes + sizeof(T));
+        this->upload(info.location, value);
+    }
+
+    /// @name 呼叫 glProgramUniform*
+    /// @{
+    void upload(GLint location, GLint value);
+    void upload(GLint location, GLuint value);
+    void upload(GLint location, GLfloat value);
+    void upload(GLint location, const glm::vec2& value);
+    void upload(GLint location, const glm::vec3& value);
+    void upload(GLint location, const glm::vec4& value);
+    void upload(GLint location, const glm::ivec2& value);
+    void upload(GLint location, const glm::mat4& value);
+    /// @}
+
     /// 讀檔轉字串
     std::string readCode(const GLchar* path);
 
@@ -0,0 +1,90 @@
+/**
+ * @file StreamBuffer.h
+ * @brief 持續映射的環狀串流buffer
+ */
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <glad/gl.h>
+
+/**
+ * @brief 持續映射（persistent mapped）的環狀串流buffer，用來上傳每個frame都會改變的資料
+ * @details
+ * 用 glBufferStorage 配置 Region_Num 個大小為 region_size 的區域，並且只映射一次（GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT）。
+ * allocate() 在目前的區域中依序切出一塊，直接寫入回傳的指標即可，不需要 glBufferData 或 glBufferSubData，
+ * 所以不會有orphaning或隱含的同步。
+ *
+ * 目前的區域用完時，在它之後放一個fence，再換到下一個區域；下一個區域若還有GPU沒執行完的指令會用到，
+ * 則等待它的fence。只要一個區域夠用一個frame，CPU最多只會領先GPU兩個frame，平常不會等待。
+ *
+ * 用法：allocate() -> 寫入 -> 用回傳的offset綁定（glBindBufferRange、glVertexAttribPointer、glCopyBufferSubData等）-> 繪製。
+ * 一次配置的資料只能在之後的兩次換區域前使用，所以每個frame都要重新寫入。
+ */
+class StreamBuffer
+{
+public:
+    /// 有幾個區域（triple buffering）
+    static constexpr int Region_Num = 3;
+
+    /// allocate() 的結果
+    struct Allocation {
+        void* ptr;        ///< 寫入的位置
+        GLintptr offset;  ///< 在buffer中的offset（bytes）
+    };
+
+private:
+    GLuint m_buffer;           ///< buffer的名字
+    GLsizeiptr m_region_size;  ///< 每個區域的大小
+    char* m_ptr;               ///< 映射的位址
+    GLsync m_fences[Region_Num]; ///< 每個區域最後一次使用後的fence，0代表沒有
+    int m_region;              ///< 目前的區域
+    GLsizeiptr m_used;         ///< 目前的區域用了多少
+
+public:
+    /**
+     * @brief 建構子
+     * @param region_size - 每個區域的大小（bytes），通常是一個frame要寫入的資料量
+     */
+    explicit StreamBuffer(GLsizeiptr region_size);
+
+    /// 等待GPU用完後呼叫 glDeleteBuffers
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /// buffer的名字
+    GLuint name() const { return m_buffer; }
+
+    /// 每個區域的大小
+    GLsizeiptr region_size() const { return m_region_size; }
+
+    /**
+     * @brief 配置一塊空間
+     * @param size - 大小（bytes）
+     * @param alignment - offset須為它的倍數（如 GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT）
+     * @throw `std::runtime_error` - 若 size 加上對齊後大於 region_size()
+     */
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    /**
+     * @brief 確保每個區域至少有 region_size bytes
+     * @details 比原本大時，等GPU用完後重新配置整個buffer（之前配置的空間都會失效）
+     */
+    void reserve(GLsizeiptr region_size);
+
+private:
+    /// 配置並映射buffer
+    void create();
+
+    /// 等待GPU用完並刪除buffer
+    void destroy();
+
+    /// 在目前的區域後放fence，換到下一個區域並等它的fence
+    void next_region();
+
+    /// 等待fence並刪除它
+    static void wait_and_delete(GLsync& fence);
+};
+
+#endif // STREAMBUFFER_H
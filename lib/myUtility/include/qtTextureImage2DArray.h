@@ -0,0 +1,76 @@
+/**
+ * @file qtTextureImage2DArray.h
+ * @brief 從多張圖載入 GL_TEXTURE_2D_ARRAY
+ */
+#ifndef QTTEXTUREIMAGE2DARRAY_H
+#define QTTEXTUREIMAGE2DARRAY_H
+
+#include <glad/gl.h>
+#include <QString>
+#include <vector>
+
+class QImage;
+
+/**
+ * @brief 包裝 GL_TEXTURE_2D_ARRAY，每一層是一張圖
+ * @details
+ * 所有層的大小相同；大小不同的圖在上傳前會縮放成array的大小。
+ * 儲存格式可以是 GL_RGBA8（預設）或 GL_R8（只需要一個channel時，例如height map，記憶體只要四分之一）。
+ * 在shader中用 `sampler2DArray`，texture coordinate 的第三個分量是第幾層。
+ */
+class qtTextureImage2DArray
+{
+private:
+    GLuint m_texture_id;
+    GLsizei m_width;
+    GLsizei m_height;
+    GLsizei m_layers;
+    GLenum m_format; ///< internal format：GL_RGBA8 或 GL_R8
+
+public:
+    /**
+     * @brief 配置一個空的texture array，之後用 set_layer() 填入每一層
+     * @param width - 每層的寬
+     * @param height - 每層的高
+     * @param layers - 層數
+     * @param internal_format - GL_RGBA8 或 GL_R8
+     */
+    qtTextureImage2DArray(GLsizei width, GLsizei height, GLsizei layers, GLenum internal_format = GL_RGBA8);
+
+    /**
+     * @brief 建構子，第i張圖放在第i層，大小以第一張圖為準
+     * @param paths - 圖片路徑
+     * @throw std::invalid_argument - 若沒有圖片或無法開啟圖片
+     */
+    explicit qtTextureImage2DArray(const std::vector<QString>& paths);
+
+    qtTextureImage2DArray(const qtTextureImage2DArray&) = delete;
+    qtTextureImage2DArray(qtTextureImage2DArray&&) = delete;
+
+    /// 呼叫glDeleteTextures
+    ~qtTextureImage2DArray();
+
+    GLsizei width() const { return m_width; }
+    GLsizei height() const { return m_height; }
+    GLsizei layers() const { return m_layers; }
+
+    /**
+     * @brief 上傳一張圖到第layer層
+     * @param layer - 第幾層
+     * @param img - 圖片，大小和array不同時會先縮放；格式不同時會先轉換（GL_R8 時轉成灰階）
+     * @pre 0 <= layer < layers()
+     */
+    void set_layer(GLsizei layer, const QImage& img);
+
+    /// 綁定到特定sampler
+    void bind_to(GLuint sampler);
+
+    /// 從特定sampler解除綁定
+    void unbind_from(GLuint sampler);
+
+private:
+    /// 配置 m_width * m_height * m_layers 的儲存空間
+    void allocate();
+};
+
+#endif // QTTEXTUREIMAGE2DARRAY_H
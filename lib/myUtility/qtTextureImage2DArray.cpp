@@ -0,0 +1,81 @@
+#include "qtTextureImage2DArray.h"
+#include <QImage>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+qtTextureImage2DArray::qtTextureImage2DArray(GLsizei width, GLsizei height, GLsizei layers, GLenum internal_format)
+    : m_texture_id(0), m_width(width), m_height(height), m_layers(layers), m_format(internal_format)
+{
+    this->allocate();
+}
+
+qtTextureImage2DArray::qtTextureImage2DArray(const std::vector<QString> &paths)
+    : m_texture_id(0), m_width(0), m_height(0), m_layers(static_cast<GLsizei>(paths.size())), m_format(GL_RGBA8)
+{
+    if (paths.empty()) throw std::invalid_argument("qtTextureImage2DArray: no image");
+
+    std::vector<QImage> images;
+    images.reserve(paths.size());
+    for (const QString& path : paths) {
+        images.emplace_back(path);
+        if (images.back().isNull()) throw std::invalid_argument(std::string("qtTextureImage2DArray: fail to open the image ").append(qPrintable(path)));
+        std::cout << "Texture: " << qPrintable(path) << " is loaded." << std::endl;
+    }
+
+    m_width = images.front().width();
+    m_height = images.front().height();
+    this->allocate();
+    for (GLsizei i = 0; i < m_layers; ++i)
+        this->set_layer(i, images[i]);
+}
+
+qtTextureImage2DArray::~qtTextureImage2DArray()
+{
+    if (m_texture_id != 0)
+        glDeleteTextures(1, &m_texture_id);
+}
+
+void qtTextureImage2DArray::allocate()
+{
+    glGenTextures(1, &m_texture_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_id);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, /* mipmap levels */ 1, m_format, m_width, m_height, m_layers);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void qtTextureImage2DArray::set_layer(GLsizei layer, const QImage &img)
+{
+    assert(0 <= layer && layer < m_layers);
+
+    const bool gray = m_format == GL_R8;
+    QImage data = img.convertToFormat(gray ? QImage::Format_Grayscale8 : QImage::Format_RGBA8888);
+    if (data.width() != m_width || data.height() != m_height)
+        data = data.scaled(m_width, m_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    // 和 qtTextureImage2D 一樣上下翻轉，使 texture coordinate 的原點在左下角
+    data = data.mirrored();
+
+    // QImage 每行對齊4 bytes，和 GL_UNPACK_ALIGNMENT 的預設值相同
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_id);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, /* mipmap level */ 0, /* offset */ 0, 0, layer,
+                    m_width, m_height, /* depth */ 1, gray ? GL_RED : GL_RGBA, GL_UNSIGNED_BYTE, data.constBits());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void qtTextureImage2DArray::bind_to(GLuint sampler)
+{
+    glActiveTexture(GL_TEXTURE0 + sampler);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_texture_id);
+}
+
+void qtTextureImage2DArray::unbind_from(GLuint sampler)
+{
+    glActiveTexture(GL_TEXTURE0 + sampler);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
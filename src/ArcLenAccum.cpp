@@ -0,0 +1,323 @@
+/**
+ * @file ArcLenAccum.cpp
+ * @brief 實作ArcLenAccum.h
+ */
+#include "ArcLenAccum.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+/// 將value wrap到 [0, period)
+static float wrap(float value, float period)
+{
+    if (period <= 0) return 0;
+
+    value = std::fmod(value, period);
+    if (value < 0) value += period;
+    if (value >= period) value = 0; // 避免 -0.000001 + period 後剛好等於period
+    return value;
+}
+
+/// @note 處理極端特例，當value很接近0或最大值時，視為0
+static bool near_boundary(float value, float period)
+{
+    return std::fabs(value) < 1.e-4 || std::fabs(value - period) < 1.e-4;
+}
+
+ArcLenAccum::ArcLenAccum()
+    : m_segment_tables(), m_segment_samples(), m_segment_S(), m_table(), m_S_index(), m_S_step(0), m_inv_S_step(0), m_T_index(), m_T_step(0), m_inv_T_step(0)
+{
+}
+
+void ArcLenAccum::clear()
+{
+    m_segment_tables.clear();
+    m_segment_samples.clear();
+    m_segment_S.clear();
+    m_table.clear();
+    this->invalidate_uniform_table();
+}
+
+// Adaptive Gauss-Legendre /////////////////////////////////////////////////////
+
+static constexpr float GL5_X[5] = { 0.f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f };
+static constexpr float GL5_W[5] = { 0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f, 0.2369268851f };
+
+/// 五點Gauss-Legendre積分，計算 |dP/dt| 在 [a, b] 的積分
+static float gauss_legendre_5(const Draw::Cubic_Segment& segment, float a, float b)
+{
+    const float half = 0.5f * (b - a);
+    const float mid = 0.5f * (a + b);
+
+    float t[5], speed[5];
+    for (int i = 0; i < 5; ++i) t[i] = mid + half * GL5_X[i];
+    Draw::evaluate_speed_batch(segment, t, 5, speed);
+
+    float sum = 0;
+    for (int i = 0; i < 5; ++i) sum += GL5_W[i] * speed[i];
+    return half * sum;
+}
+
+/// 將 [a, b] 切成四等份，分別做五點Gauss-Legendre積分，二十個點一起批次求速率
+static void gauss_legendre_5_quarters(const Draw::Cubic_Segment& segment, float a, float b, float quarters[4])
+{
+    const float half = 0.125f * (b - a);
+
+    float t[20], speed[20];
+    for (int q = 0; q < 4; ++q) {
+        const float mid = a + (2 * q + 1) * half;
+        for (int i = 0; i < 5; ++i)
+            t[5 * q + i] = mid + half * GL5_X[i];
+    }
+    Draw::evaluate_speed_batch(segment, t, 20, speed);
+
+    for (int q = 0; q < 4; ++q) {
+        float sum = 0;
+        for (int i = 0; i < 5; ++i)
+            sum += GL5_W[i] * speed[5 * q + i];
+        quarters[q] = half * sum;
+    }
+}
+
+/// 最少對半切幾層（一段至少 2^MIN_DEPTH 項）
+constexpr int MIN_DEPTH = 1;
+/// 最多對半切幾層（一段最多 2^MAX_DEPTH 項）
+constexpr int MAX_DEPTH = 10;
+
+/**
+ * @brief 遞迴細分 [a, b]，並依序將每個小區間終點的 (t, s) 加入table
+ * @details
+ * 至少切 MIN_DEPTH 層；之後下列兩個條件都成立才不再細分：
+ * 1. 切開前後的積分結果相差不超過 tol（曲線長夠準）
+ * 2. 在 1/4、1/2、3/4 處，累積長度和線性內插的結果相差都不超過 lerp_tol（用線性內插查表時夠準）。
+ *    只檢查中點是不夠的：對稱的曲線在中點一定剛好等於一半，但在其他地方可能差很多
+ * @param whole - [a, b] 的長度
+ * @param S0 - a 的累積長度
+ * @param tol - 這個區間的積分可接受的誤差（每切一次就分給兩半）
+ * @param lerp_tol - 線性內插可接受的誤差（只影響區間內，所以不用分）
+ */
+static void subdivide(ArcLenAccum::Table_T& table, const Draw::Cubic_Segment& segment,
+                      float a, float b, float whole, float S0, float tol, float lerp_tol, int depth)
+{
+    float q[4];
+    gauss_legendre_5_quarters(segment, a, b, q);
+    const float left = q[0] + q[1], right = q[2] + q[3];
+    const float sum = left + right;
+
+    const bool accurate = depth >= MIN_DEPTH
+                          && std::fabs(sum - whole) <= tol                      // 積分夠準
+                          && std::fabs(q[0] - 0.25f * sum) <= lerp_tol          // 線性內插夠準
+                          && std::fabs(left - 0.5f * sum) <= lerp_tol
+                          && std::fabs(left + q[2] - 0.75f * sum) <= lerp_tol;
+    if (accurate || depth >= MAX_DEPTH) {
+        table.emplace_back(b, S0 + sum);
+        return;
+    }
+
+    // 積分的誤差分給兩半
+    const float m = 0.5f * (a + b);
+    subdivide(table, segment, a, m, left, S0, 0.5f * tol, lerp_tol, depth + 1);
+    subdivide(table, segment, m, b, right, S0 + left, 0.5f * tol, lerp_tol, depth + 1);
+}
+
+/// 建立一段曲線的區域表
+static ArcLenAccum::Table_T integrate_segment(const Draw::Cubic_Segment& segment, float tolerance)
+{
+    ArcLenAccum::Table_T table;
+    subdivide(table, segment, 0.f, 1.f, gauss_legendre_5(segment, 0.f, 1.f), 0.f, tolerance, tolerance, 0);
+    return table;
+}
+
+int ArcLenAccum::append_segment(const Draw::Cubic_Segment &segment, float tolerance)
+{
+    return this->insert_segment(m_segment_tables.size(), segment, tolerance);
+}
+
+int ArcLenAccum::set_segment(size_t i, const Draw::Cubic_Segment &segment, float tolerance)
+{
+    assert(i < m_segment_tables.size());
+    this->invalidate_uniform_table();
+
+    m_segment_tables[i] = integrate_segment(segment, tolerance);
+    m_segment_samples[i] = static_cast<int>(m_segment_tables[i].size());
+    return m_segment_samples[i];
+}
+
+int ArcLenAccum::insert_segment(size_t i, const Draw::Cubic_Segment &segment, float tolerance)
+{
+    assert(i <= m_segment_tables.size());
+    this->invalidate_uniform_table();
+
+    auto it = m_segment_tables.insert(m_segment_tables.begin() + i, integrate_segment(segment, tolerance));
+    const int samples = static_cast<int>(it->size());
+    m_segment_samples.insert(m_segment_samples.begin() + i, samples);
+    return samples;
+}
+
+void ArcLenAccum::erase_segment(size_t i)
+{
+    assert(i < m_segment_tables.size());
+    this->invalidate_uniform_table();
+
+    m_segment_tables.erase(m_segment_tables.begin() + i);
+    m_segment_samples.erase(m_segment_samples.begin() + i);
+}
+
+int ArcLenAccum::append_table(Table_T table)
+{
+    assert(!table.empty());
+    this->invalidate_uniform_table();
+
+    const int samples = static_cast<int>(table.size());
+    m_segment_tables.push_back(std::move(table));
+    m_segment_samples.push_back(samples);
+    return samples;
+}
+
+void ArcLenAccum::finalize(size_t resolution)
+{
+    assert(!m_segment_tables.empty());
+    const size_t N = m_segment_tables.size();
+
+    // 前綴和
+    m_segment_S.resize(N + 1);
+    m_segment_S[0] = 0;
+    size_t total = 1;
+    for (size_t i = 0; i < N; ++i) {
+        m_segment_S[i + 1] = m_segment_S[i] + m_segment_tables[i].back().second;
+        total += m_segment_tables[i].size();
+    }
+
+    // 將區域表接成原始表
+    m_table.clear();
+    m_table.reserve(total);
+    m_table.emplace_back(0.f, 0.f);
+    for (size_t i = 0; i < N; ++i) {
+        for (const auto& elem : m_segment_tables[i])
+            m_table.emplace_back(i + elem.first, m_segment_S[i] + elem.second);
+    }
+
+    this->build_uniform_table(resolution);
+}
+
+void ArcLenAccum::invalidate_uniform_table()
+{
+    m_S_index.clear();
+    m_T_index.clear();
+}
+
+// Uniform Table ////////////////////////////////////////////////////////////////
+
+/**
+ * @brief 建立一張均勻表：第k格為 k * step 落在原始表的第幾個區間
+ * @param get - 取出原始表中某項的T或S
+ */
+template<typename Getter>
+static std::vector<uint32_t> build_index(const ArcLenAccum::Table_T& table, size_t resolution, float step, Getter get)
+{
+    // merge-walk，從頭到尾只走過原始表一次
+    std::vector<uint32_t> index(resolution + 1);
+    size_t j = 0;
+    for (size_t k = 0; k <= resolution; ++k) {
+        const float x = k * step;
+        while (j + 2 < table.size() && get(table[j + 1]) <= x) ++j;
+        index[k] = static_cast<uint32_t>(j);
+    }
+    return index;
+}
+
+/**
+ * @brief 從均勻表找出 x 所在的原始表區間
+ * @details 從格子記錄的區間往後走，直到下一項超過 x（同一格內的區間數通常不超過一兩個）
+ */
+template<typename Getter>
+static size_t find_interval(const ArcLenAccum::Table_T& table, const std::vector<uint32_t>& index, float inv_step, float x, Getter get)
+{
+    const size_t k = std::min(static_cast<size_t>(x * inv_step), index.size() - 1);
+    size_t j = index[k];
+    while (j + 2 < table.size() && get(table[j + 1]) <= x) ++j;
+    return j;
+}
+
+void ArcLenAccum::build_uniform_table(size_t resolution)
+{
+    this->invalidate_uniform_table();
+
+    // 長度為0時無法建表，之後查表會退回二分搜尋
+    if (max_S() <= 0 || max_T() <= 0) return;
+
+    if (resolution == 0)
+        resolution = 2 * m_table.size();
+
+    m_S_step = max_S() / resolution;
+    m_inv_S_step = 1.f / m_S_step;
+    m_S_index = build_index(m_table, resolution, m_S_step, [](const std::pair<float, float>& e) { return e.second; });
+
+    m_T_step = max_T() / resolution;
+    m_inv_T_step = 1.f / m_T_step;
+    m_T_index = build_index(m_table, resolution, m_T_step, [](const std::pair<float, float>& e) { return e.first; });
+}
+
+// Lookup ///////////////////////////////////////////////////////////////////////
+
+float ArcLenAccum::T_to_S(float T) const
+{
+    if (!this->has_uniform_table())
+        return this->T_to_S_bsearch(T);
+
+    T = wrap(T, max_T());
+    if (near_boundary(T, max_T())) return 0;
+
+    const size_t j = find_interval(m_table, m_T_index, m_inv_T_step, T, [](const std::pair<float, float>& e) { return e.first; });
+    const auto& low = m_table[j];
+    const auto& high = m_table[j + 1];
+    const float dT = high.first - low.first;
+    return dT > 0 ? low.second + (T - low.first) / dT * (high.second - low.second) : low.second;
+}
+
+float ArcLenAccum::S_to_T(float S) const
+{
+    if (!this->has_uniform_table())
+        return this->S_to_T_bsearch(S);
+
+    S = wrap(S, max_S());
+    if (near_boundary(S, max_S())) return 0;
+
+    const size_t j = find_interval(m_table, m_S_index, m_inv_S_step, S, [](const std::pair<float, float>& e) { return e.second; });
+    const auto& low = m_table[j];
+    const auto& high = m_table[j + 1];
+    const float dS = high.second - low.second;
+    const float T = dS > 0 ? low.first + (S - low.second) / dS * (high.first - low.first) : low.first;
+    return T < max_T() ? T : 0.f;
+}
+
+float ArcLenAccum::T_to_S_bsearch(float T) const
+{
+    T = wrap(T, max_T());
+    if (near_boundary(T, max_T())) return 0;
+
+    // 第一個 first > T 的項，則 T 落在 [it - 1, it) 之間
+    auto it = std::upper_bound(m_table.begin() + 1, m_table.end(), T,
+                               [](float value, const std::pair<float, float>& elem) { return value < elem.first; });
+    if (it == m_table.end()) return max_S();
+
+    const auto& low = *(it - 1);
+    const auto& high = *it;
+    return low.second + (T - low.first) / (high.first - low.first) * (high.second - low.second);
+}
+
+float ArcLenAccum::S_to_T_bsearch(float S) const
+{
+    S = wrap(S, max_S());
+    if (near_boundary(S, max_S())) return 0;
+
+    // 第一個 second > S 的項，則 S 落在 [it - 1, it) 之間
+    auto it = std::upper_bound(m_table.begin() + 1, m_table.end(), S,
+                               [](float value, const std::pair<float, float>& elem) { return value < elem.second; });
+    if (it == m_table.end()) return 0;
+
+    const auto& low = *(it - 1);
+    const auto& high = *it;
+    const float T = low.first + (S - low.second) / (high.second - low.second) * (high.first - low.first);
+    return T < max_T() ? T : 0.f;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file ArcLenAccum.h
+ * @brief 曲線長累積表，負責參數空間T和實際距離S間的轉換
+ */
+#ifndef ARCLENACCUM_H
+#define ARCLENACCUM_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "ParamEquation.h"
+
+/**
+ * @brief 曲線長累積表
+ * @details
+ * 內部有三層：
+ * - 每段曲線的區域表：第i段曲線內的 (t, s)，t 介於 (0, 1]，s 從這段的起點算起。只有這段曲線改變時才需要重新積分。
+ * - 原始表：將區域表接起來（T = i + t，S = 第i段起點的累積長度 + s）。T 和 S 都遞增，但間隔不一定相等。查表時用二分搜尋。
+ * - 均勻表：將 S（和 T）切成間隔相等的格子，每格記錄這格起點落在原始表的第幾個區間。
+ *   查表時算出格子後，從記錄的區間往後找（通常不用走或只走一兩步），再在原始表的區間內線性內插。
+ *   所以結果和二分搜尋完全相同，曲線的段與段之間（例如直線軌道的轉角）不會被均勻的格子磨圓。
+ *
+ * 修改區域表（append_segment()、set_segment()、insert_segment()、erase_segment()）後，
+ * 要呼叫 finalize() 重算每段起點的累積長度，並重建原始表和均勻表，之後才能查表。
+ * 所以只改動少數幾段曲線時，只需要重新積分那幾段，再做一次O(n)的前綴和。
+ *
+ * 當均勻表存在時，T_to_S() 和 S_to_T() 會使用均勻表；否則退回二分搜尋。
+ */
+class ArcLenAccum
+{
+public:
+    /// @brief 原始表的型別
+    /// @details elem.first = t in "param space", elem.second = s in "real space"
+    typedef std::vector< std::pair< float, float > > Table_T;
+
+private:
+    std::vector<Table_T> m_segment_tables; ///< 第i項為第i段曲線的區域表（不含 (0, 0) 那項）
+    std::vector<int> m_segment_samples;    ///< 第i項為第i段曲線的區域表有幾項
+    std::vector<float> m_segment_S;        ///< 第i項為第i段曲線起點的累積長度，最後一項為總長
+
+    Table_T m_table; ///< 原始表
+
+    std::vector<uint32_t> m_S_index; ///< 均勻表：第k項為 S = k * m_S_step 落在原始表的第幾個區間
+    float m_S_step;                  ///< m_S_index 的間隔
+    float m_inv_S_step;              ///< 1 / m_S_step
+
+    std::vector<uint32_t> m_T_index; ///< 均勻表：第k項為 T = k * m_T_step 落在原始表的第幾個區間
+    float m_T_step;                  ///< m_T_index 的間隔
+    float m_inv_T_step;              ///< 1 / m_T_step
+
+public:
+    ArcLenAccum();
+
+    /// @name 區域表
+    /// @{
+
+    /// 清空所有表
+    void clear();
+
+    /**
+     * @brief 用適應性的Gauss-Legendre積分，將一段曲線的區域表加在最後
+     * @details
+     * 將 [0, 1] 遞迴對半切（至少切一次），直到下列兩個條件都成立才不再細分：
+     * 1. 切開前後的積分結果相差不超過 tolerance（曲線長夠準）
+     * 2. 在區間的 1/4、1/2、3/4 處，累積長度和線性內插的結果相差都不超過 tolerance（用線性內插查表時夠準）
+     *
+     * 直線上只需要很少項；彎曲或速率變化大的地方才會多取樣。
+     * @param segment - 這段曲線，對它的速率 |dP/dt| 積分
+     * @param tolerance - 可接受的誤差（實際距離）
+     * @return 區域表有幾項
+     */
+    int append_segment(const Draw::Cubic_Segment& segment, float tolerance);
+
+    /// @brief 同 append_segment()，但重新計算第i段曲線的區域表
+    int set_segment(size_t i, const Draw::Cubic_Segment& segment, float tolerance);
+
+    /// @brief 同 append_segment()，但插入在第i段，原本第i段之後的都往後移一段
+    int insert_segment(size_t i, const Draw::Cubic_Segment& segment, float tolerance);
+
+    /// @brief 刪除第i段曲線的區域表，之後的都往前移一段
+    void erase_segment(size_t i);
+
+    /**
+     * @brief 將已經算好的區域表（如從檔案讀入的）加在最後，不需要再積分
+     * @param table - 這段曲線的區域表，t 遞增且最後一項的 t 為1
+     * @return 區域表有幾項
+     */
+    int append_table(Table_T table);
+
+    /// 第i項為第i段曲線的區域表
+    const std::vector<Table_T>& segment_tables() const { return m_segment_tables; }
+
+    /// 共有幾段曲線
+    size_t segment_num() const { return m_segment_tables.size(); }
+
+    /// 第i項為第i段曲線的區域表有幾項
+    const std::vector<int>& segment_samples() const { return m_segment_samples; }
+
+    /**
+     * @brief 依照區域表重算前綴和，並重建原始表和均勻表
+     * @param resolution - 均勻表要切成幾格。若為0，則為原始表大小的2倍（平均每格不到一個區間）
+     * @pre 至少有一段曲線
+     */
+    void finalize(size_t resolution = 0);
+
+    /// @}
+
+    /// @name 原始表
+    /// @brief 呼叫 finalize() 後才有效
+    /// @{
+
+    /// 取得原始表
+    const Table_T& table() const { return m_table; }
+
+    /// 原始表是否為空
+    bool empty() const { return m_table.empty(); }
+
+    /// 最大的參數（整條軌道在參數空間的長度）
+    float max_T() const { return m_table.back().first; }
+
+    /// 最大的距離（整條軌道的長度）
+    float max_S() const { return m_table.back().second; }
+
+    /// @}
+
+    /// 均勻表是否可用
+    bool has_uniform_table() const { return !m_S_index.empty(); }
+
+    /**
+     * @brief 將參數空間中的T 換成 實際距離S
+     * @details 超出範圍時會先做wrap。有均勻表時平均為O(1)，否則為O(log n)；兩者結果相同
+     */
+    float T_to_S(float T) const;
+
+    /**
+     * @brief 將實際距離S 換成 參數空間中的T
+     * @details 超出範圍時會先做wrap。有均勻表時平均為O(1)，否則為O(log n)；兩者結果相同
+     * @return 介於 [0, max_T()) 間
+     */
+    float S_to_T(float S) const;
+
+    /// 同 T_to_S()，但一定使用二分搜尋
+    float T_to_S_bsearch(float T) const;
+
+    /// 同 S_to_T()，但一定使用二分搜尋
+    float S_to_T_bsearch(float S) const;
+
+private:
+    /// 使均勻表失效
+    void invalidate_uniform_table();
+
+    /// 依照原始表建立均勻表
+    void build_uniform_table(size_t resolution);
+};
+
+#endif // ARCLENACCUM_H
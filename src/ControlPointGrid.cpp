@@ -0,0 +1,208 @@
+#include "ControlPointGrid.h"
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
+#include <utility>
+
+/// 格子座標的範圍，留一點空間讓 pick() 的 ±1 不會溢位
+constexpr float Max_Cell_Coord = float(1 << 30);
+
+ControlPointGrid::ControlPointGrid(float cell_size)
+    : m_cell_size(cell_size), m_inv_cell_size(1.f / cell_size), m_cells(), m_positions(), m_cell_of(),
+    m_min_x(INT_MAX), m_max_x(INT_MIN), m_min_z(INT_MAX), m_max_z(INT_MIN)
+{
+}
+
+int ControlPointGrid::cell_coord(float v) const
+{
+    // 先夾在int的範圍內再轉型，座標很大（或為NaN）時轉型是未定義行為
+    const float c = std::floor(v * m_inv_cell_size);
+    if (!(c > -Max_Cell_Coord))
+        return -static_cast<int>(Max_Cell_Coord);
+    if (c > Max_Cell_Coord)
+        return static_cast<int>(Max_Cell_Coord);
+    return static_cast<int>(c);
+}
+
+uint64_t ControlPointGrid::key(int x, int z)
+{
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(z);
+}
+
+void ControlPointGrid::insert(int i)
+{
+    const int x = cell_coord(m_positions[i].x), z = cell_coord(m_positions[i].z);
+    m_cell_of[i] = key(x, z);
+    m_cells[m_cell_of[i]].push_back(i);
+
+    m_min_x = std::min(m_min_x, x);
+    m_max_x = std::max(m_max_x, x);
+    m_min_z = std::min(m_min_z, z);
+    m_max_z = std::max(m_max_z, z);
+}
+
+void ControlPointGrid::remove(int i)
+{
+    auto it = m_cells.find(m_cell_of[i]);
+    std::vector<int>& cell = it->second;
+    cell.erase(std::find(cell.begin(), cell.end(), i));
+    if (cell.empty())
+        m_cells.erase(it);
+}
+
+void ControlPointGrid::rebuild(const std::vector<ControlPoint> &control_points)
+{
+    m_cells.clear();
+    m_min_x = m_min_z = INT_MAX;
+    m_max_x = m_max_z = INT_MIN;
+
+    m_positions.resize(control_points.size());
+    m_cell_of.resize(control_points.size());
+    for (size_t i = 0; i < control_points.size(); ++i) {
+        m_positions[i] = control_points[i].pos;
+        this->insert(static_cast<int>(i));
+    }
+}
+
+void ControlPointGrid::move(int i, const glm::vec3 &pos)
+{
+    m_positions[i] = pos;
+    if (key(cell_coord(pos.x), cell_coord(pos.z)) == m_cell_of[i])
+        return;
+
+    this->remove(i);
+    this->insert(i);
+}
+
+int ControlPointGrid::pick(const glm::vec3 &pos, const glm::vec3 &lower, const glm::vec3 &upper) const
+{
+    // 範圍的水平大小不大於格子的邊長，所以只需要檢查周圍 3x3 格
+    const int cx = cell_coord(pos.x), cz = cell_coord(pos.z);
+    int best = -1;
+    for (int x = cx - 1; x <= cx + 1; ++x) {
+        for (int z = cz - 1; z <= cz + 1; ++z) {
+            auto it = m_cells.find(key(x, z));
+            if (it == m_cells.end())
+                continue;
+
+            for (int i : it->second) {
+                const glm::vec3 delta = pos - m_positions[i];
+                const bool inside = delta.x >= -lower.x && delta.y >= -lower.y && delta.z >= -lower.z &&
+                                    delta.x <= upper.x && delta.y <= upper.y && delta.z <= upper.z;
+                if (inside && (best < 0 || i < best))
+                    best = i;
+            }
+        }
+    }
+    return best;
+}
+
+std::vector<int> ControlPointGrid::query_box(const glm::vec3 &min, const glm::vec3 &max) const
+{
+    std::vector<int> result;
+    auto test = [&](int i) {
+        const glm::vec3& p = m_positions[i];
+        if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z)
+            result.push_back(i);
+    };
+
+    const int x0 = std::max(cell_coord(min.x), m_min_x), x1 = std::min(cell_coord(max.x), m_max_x);
+    const int z0 = std::max(cell_coord(min.z), m_min_z), z1 = std::min(cell_coord(max.z), m_max_z);
+    if (x0 > x1 || z0 > z1)
+        return result;
+
+    // 框比有控制點的格子數還大時，直接檢查每個有控制點的格子
+    if ((double(x1) - x0 + 1) * (double(z1) - z0 + 1) > double(m_cells.size())) {
+        for (const auto& cell : m_cells) {
+            for (int i : cell.second)
+                test(i);
+        }
+    }
+    else {
+        for (int x = x0; x <= x1; ++x) {
+            for (int z = z0; z <= z1; ++z) {
+                auto it = m_cells.find(key(x, z));
+                if (it == m_cells.end())
+                    continue;
+                for (int i : it->second)
+                    test(i);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<int> ControlPointGrid::nearest(const glm::vec3 &pos, size_t n) const
+{
+    n = std::min(n, m_positions.size());
+    if (n == 0)
+        return {};
+
+    // 以 (距離平方, index) 為元素的max heap，保留目前最近的n個
+    std::priority_queue<std::pair<float, int>> heap;
+    auto consider = [&](int i) {
+        const glm::vec3 d = m_positions[i] - pos;
+        const float d2 = glm::dot(d, d);
+        if (heap.size() < n)
+            heap.emplace(d2, i);
+        else if (d2 < heap.top().first) {
+            heap.pop();
+            heap.emplace(d2, i);
+        }
+    };
+
+    // 由內往外一圈一圈檢查格子。第r圈處理完後，還沒檢查的點水平距離至少為 r * cell_size
+    // 格子座標夾在 ±2^30，相減可能超出int，所以用64位元算
+    const int64_t cx = cell_coord(pos.x), cz = cell_coord(pos.z);
+    for (int64_t r = 0;; ++r) {
+        // 這一圈的格子比有控制點的格子還多時，直接檢查剩下的所有點
+        if (double(8 * r) > double(m_cells.size())) {
+            for (const auto& cell : m_cells) {
+                const int64_t x = static_cast<int32_t>(cell.first >> 32), z = static_cast<int32_t>(cell.first & 0xffffffffu);
+                if (std::max(std::abs(x - cx), std::abs(z - cz)) < r)
+                    continue;
+                for (int i : cell.second)
+                    consider(i);
+            }
+            break;
+        }
+
+        auto visit = [&](int64_t x, int64_t z) {
+            auto it = m_cells.find(key(static_cast<int>(x), static_cast<int>(z)));
+            if (it != m_cells.end()) {
+                for (int i : it->second)
+                    consider(i);
+            }
+        };
+        if (r == 0) {
+            visit(cx, cz);
+        }
+        else { // 只走這一圈的邊
+            for (int64_t x = cx - r; x <= cx + r; ++x) {
+                visit(x, cz - r);
+                visit(x, cz + r);
+            }
+            for (int64_t z = cz - r + 1; z <= cz + r - 1; ++z) {
+                visit(cx - r, z);
+                visit(cx + r, z);
+            }
+        }
+
+        const float bound = r * m_cell_size;
+        if (heap.size() == n && heap.top().first <= bound * bound)
+            break;
+        // 已經涵蓋所有有控制點的格子
+        if (cx - r <= m_min_x && cx + r >= m_max_x && cz - r <= m_min_z && cz + r >= m_max_z)
+            break;
+    }
+
+    std::vector<int> result(heap.size());
+    for (size_t k = result.size(); k-- > 0; heap.pop())
+        result[k] = heap.top().second;
+    return result;
+}
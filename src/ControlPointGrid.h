@@ -0,0 +1,69 @@
+/**
+ * @file ControlPointGrid.h
+ * @brief 控制點的空間索引
+ */
+#ifndef CONTROLPOINTGRID_H
+#define CONTROLPOINTGRID_H
+
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "TrackCurve.h"
+
+/**
+ * @brief 控制點的空間索引
+ * @details
+ * 將水平面(x, z)切成邊長為 cell_size 的格子，每格記錄落在其中的控制點的index（只存有控制點的格子）。
+ * 點擊、框選和找最近的幾個控制點時，只需要檢查附近的格子，不用逐一檢查所有控制點。
+ *
+ * 拖移一個控制點時用 move() 只更新那個點（O(1)）；新增、刪除、匯入控制點時index會位移，用 rebuild() 整個重建（O(n)）。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class ControlPointGrid
+{
+private:
+    float m_cell_size;
+    float m_inv_cell_size;
+    std::unordered_map<uint64_t, std::vector<int>> m_cells; ///< 格子 -> 其中的控制點
+    std::vector<glm::vec3> m_positions; ///< 第i項為第i個控制點的位置
+    std::vector<uint64_t> m_cell_of;    ///< 第i項為第i個控制點所在的格子
+    int m_min_x, m_max_x, m_min_z, m_max_z; ///< 曾經有控制點的格子的範圍
+
+public:
+    /// @param cell_size - 格子的邊長，應大於等於點擊範圍的水平大小
+    explicit ControlPointGrid(float cell_size);
+
+    /// 依照所有控制點重建
+    void rebuild(const std::vector<ControlPoint>& control_points);
+
+    /// 第i個控制點移動到 pos
+    void move(int i, const glm::vec3& pos);
+
+    /**
+     * @brief 點擊
+     * @details 控制點 p 的範圍為軸對齊的box [p - lower, p + upper]，包含邊界（和 RayCast::box() 打到的範圍一致）
+     * @param pos - 點擊的位置
+     * @param lower - 範圍往負方向延伸多少，x和z不可大於 cell_size
+     * @param upper - 範圍往正方向延伸多少，x和z不可大於 cell_size
+     * @return 範圍包含 pos 的控制點中index最小的；沒有則回傳-1
+     */
+    int pick(const glm::vec3& pos, const glm::vec3& lower, const glm::vec3& upper) const;
+
+    /// 框選：位置在 [min, max] 內的所有控制點，index由小到大
+    std::vector<int> query_box(const glm::vec3& min, const glm::vec3& max) const;
+
+    /// 離 pos 最近的（最多）n 個控制點，由近到遠
+    std::vector<int> nearest(const glm::vec3& pos, size_t n) const;
+
+private:
+    /// 座標 v 在第幾格，超出int範圍時夾在 ±2^30
+    int cell_coord(float v) const;
+    static uint64_t key(int x, int z);
+    void insert(int i);
+    void remove(int i);
+};
+
+#endif // CONTROLPOINTGRID_H
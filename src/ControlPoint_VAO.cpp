@@ -1,7 +1,15 @@
 
 #include "ControlPoint_VAO.h"
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+/// m_staging 每個區域一開始放得下幾個 Instance
+constexpr GLsizei Initial_Staging_Instances = 64;
 
 ControlPoint_VAO::ControlPoint_VAO(float size)
+    : m_vbo(0), m_instance_vbo(0), m_instance_num(0), m_instance_capacity(0),
+    m_staging(Initial_Staging_Instances * sizeof(Instance))
 {
     GLfloat vbo_data[] = {
         //  position          normal
@@ -50,16 +58,63 @@ ControlPoint_VAO::ControlPoint_VAO(float size)
     glVertexAttribPointer(2, 3, GL_FLOAT, false, 6 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
     glEnableVertexAttribArray(2);
 
+    glGenBuffers(1, &m_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    // 3 -> aCpPos
+    glVertexAttribPointer(3, 3, GL_FLOAT, false, sizeof(Instance), (void*)offsetof(Instance, pos));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    // 4 -> aCpOrient
+    glVertexAttribPointer(4, 3, GL_FLOAT, false, sizeof(Instance), (void*)offsetof(Instance, orient));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+    // 5 -> aSelected
+    glVertexAttribPointer(5, 1, GL_FLOAT, false, sizeof(Instance), (void*)offsetof(Instance, selected));
+    glEnableVertexAttribArray(5);
+    glVertexAttribDivisor(5, 1);
+
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+ControlPoint_VAO::~ControlPoint_VAO()
+{
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_instance_vbo);
+}
+
+void ControlPoint_VAO::set_instances(const std::vector<Instance> &instances)
+{
+    m_instance_num = static_cast<GLsizei>(instances.size());
+    if (m_instance_num == 0)
+        return;
+
+    const GLsizeiptr bytes = instances.size() * sizeof(Instance);
+    if (m_instance_num > m_instance_capacity) {
+        // 只有控制點變多時才重新配置，每次加倍
+        m_instance_capacity = std::max(m_instance_num, 2 * m_instance_capacity);
+        glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+        glBufferData(GL_ARRAY_BUFFER, m_instance_capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_staging.reserve(m_instance_capacity * sizeof(Instance));
+    }
+
+    const StreamBuffer::Allocation a = m_staging.allocate(bytes);
+    std::memcpy(a.ptr, instances.data(), bytes);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_staging.name());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_instance_vbo);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, a.offset, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 void ControlPoint_VAO::draw()
 {
     glBindVertexArray(m_VAO_id);
 
-    glDrawArrays(GL_QUADS, 0, 20);
-    glDrawArrays(GL_TRIANGLE_FAN, 20, 6);
+    glDrawArraysInstanced(GL_QUADS, 0, 20, m_instance_num);
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 20, 6, m_instance_num);
 
     glBindVertexArray(0);
 }
@@ -3,21 +3,51 @@
 #define CONTROLPOINT_VAO_H
 
 #include <VAO_Interface.h>
+#include <StreamBuffer.h>
+#include <vector>
+#include <glm/vec3.hpp>
 
 /**
  * @brief 控制點的三角錐
  * @details
+ * 所有控制點共用一個mesh，每個控制點的位置、orient、是否被選中放在instance buffer中，
+ * 呼叫 draw() 時用instanced draw一次畫出所有控制點。
+ * 修改instance時先寫進 StreamBuffer，再在GPU上複製到instance buffer；instance buffer只在控制點變多時才重新配置。
+ *
  * 提供的Attribute:
  * - (location = 0) aPos
  * - (location = 2) aNormal
+ * - (location = 3) aCpPos，每個instance的位置
+ * - (location = 4) aCpOrient，每個instance的orient
+ * - (location = 5) aSelected，每個instance是否被選中（1或0）
  */
 class ControlPoint_VAO : public VAO_Interface
 {
+public:
+    /// instance buffer中的一項
+    struct Instance {
+        glm::vec3 pos;    ///< 位置
+        glm::vec3 orient; ///< orient
+        float selected;   ///< 是否被選中（1或0）
+    };
+
+private:
     GLuint m_vbo;
+    GLuint m_instance_vbo; ///< 每個控制點的 Instance
+    GLsizei m_instance_num; ///< 有幾個控制點
+    GLsizei m_instance_capacity; ///< m_instance_vbo 放得下幾個 Instance
+    StreamBuffer m_staging; ///< 上傳 Instance 用
 
 public:
     ControlPoint_VAO(float size);
 
+    /// 呼叫 glDeleteBuffers
+    ~ControlPoint_VAO();
+
+    /// 更新instance buffer（只在控制點被修改或選取改變時需要呼叫）
+    void set_instances(const std::vector<Instance>& instances);
+
+    /// 一次畫出所有控制點
     void draw() override;
 };
 
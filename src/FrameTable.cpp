@@ -0,0 +1,158 @@
+#include "FrameTable.h"
+#include <glm/geometric.hpp>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+/// orient和前進方向夾角的sin大於這個值時，完全跟著orient；小於時逐漸改用平行移動的結果
+constexpr float Orient_Blend_Sin = 0.25f;
+
+/// 用TOP和FRONT補上LEFT，並讓三者兩兩垂直
+static FrameTable::Frame make_frame(const glm::vec3& pos, const glm::vec3& FRONT, const glm::vec3& top)
+{
+    const glm::vec3 LEFT = glm::normalize(glm::cross(top, FRONT));
+    return { pos, FRONT, LEFT, glm::cross(FRONT, LEFT) };
+}
+
+/// 任一個和 v 垂直的單位向量
+static glm::vec3 any_perpendicular(const glm::vec3& v)
+{
+    const glm::vec3 axis = (std::abs(v.y) < 0.9f) ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+    return glm::normalize(axis - glm::dot(axis, v) * v);
+}
+
+FrameTable::FrameTable(float interval)
+    : m_frames(), m_interval(interval), m_step(0.f), m_length(0.f)
+{
+}
+
+void FrameTable::rebuild(const TrackCurve &track)
+{
+    m_length = track.length();
+    const size_t N = std::max<size_t>(1, static_cast<size_t>(std::ceil(m_length / m_interval)));
+    m_step = m_length / N;
+
+    // 批次求出每個取樣點的位置和orient
+    std::vector<size_t> cp_ids(N);
+    std::vector<float> ts(N);
+    for (size_t k = 0; k < N; ++k)
+        cp_ids[k] = track.locate(track.S_to_T(k * m_step), ts[k]);
+    Draw::Points_SoA points, orients;
+    track.batch_points(cp_ids.data(), ts.data(), N, points);
+    track.batch_orients(cp_ids.data(), ts.data(), N, orients);
+
+    // 用前後兩點求前進的方向，退化時沿用前一個
+    std::vector<glm::vec3> fronts(N);
+    glm::vec3 FRONT(0, 0, 1);
+    for (size_t k = 0; k < N; ++k) {
+        const glm::vec3 u = points[(k + 1) % N] - points[(k + N - 1) % N];
+        if (glm::length(u) > 1.e-6f)
+            FRONT = glm::normalize(u);
+        fronts[k] = FRONT;
+    }
+
+    // 由起點沿著軌道決定每個座標系，每一步再多繞FRONT轉 twist。第N步回到起點，回傳那裡的top（不存進表中）
+    m_frames.resize(N + 1);
+    auto sweep = [&](float twist) {
+        glm::vec3 top(0.f);
+        for (size_t k = 0; k <= N; ++k) {
+            const size_t j = k % N;
+            const glm::vec3 pos = points[j];
+            const glm::vec3 FRONT = fronts[j];
+
+            if (k == 0) {
+                top = any_perpendicular(FRONT);
+            }
+            else {
+                // double reflection：把上一個座標系的top平行移動過來
+                const glm::vec3 v1 = pos - m_frames[k - 1].pos;
+                const float c1 = glm::dot(v1, v1);
+                glm::vec3 top_L = top, front_L = m_frames[k - 1].FRONT;
+                if (c1 > 1.e-12f) {
+                    top_L -= (2.f / c1) * glm::dot(v1, top) * v1;
+                    front_L -= (2.f / c1) * glm::dot(v1, front_L) * v1;
+                }
+                const glm::vec3 v2 = FRONT - front_L;
+                const float c2 = glm::dot(v2, v2);
+                top = (c2 > 1.e-12f) ? top_L - (2.f / c2) * glm::dot(v2, top_L) * v2 : top_L;
+                if (twist != 0.f)
+                    top = std::cos(twist) * top + std::sin(twist) * glm::cross(FRONT, top);
+            }
+
+            // 和控制點的orient混合：orient越不平行於FRONT，越以orient為準
+            const glm::vec3 orient = orients[j];
+            if (glm::length(orient) > 1.e-6f) {
+                const glm::vec3 on = glm::normalize(orient);
+                const glm::vec3 perp = on - glm::dot(on, FRONT) * FRONT;
+                const float sin = glm::length(perp);
+                const float w = std::min(sin / Orient_Blend_Sin, 1.f);
+                if (w > 0.f)
+                    top = top * (1.f - w) + (perp / sin) * w;
+            }
+            top -= glm::dot(top, FRONT) * FRONT;
+            top = (glm::length(top) > 1.e-6f) ? glm::normalize(top) : any_perpendicular(FRONT);
+
+            if (k < N)
+                m_frames[k] = make_frame(pos, FRONT, top);
+        }
+        return top;
+    };
+
+    // 平行移動繞一圈後，top和起點的通常差一個角度（holonomy），直接接回起點會在那裡突然扭轉。
+    // 量出這個角度後重做一次，每一步多轉 1/N，讓扭轉平均分散在整條軌道上
+    const glm::vec3 top_end = sweep(0.f);
+    const Frame& first = m_frames[0];
+    const float holonomy = std::atan2(glm::dot(glm::cross(top_end, first.TOP), first.FRONT), glm::dot(top_end, first.TOP));
+    if (std::abs(holonomy) > 1.e-5f)
+        sweep(holonomy / N);
+    m_frames[N] = m_frames[0]; // 接回起點
+}
+
+FrameTable::Frame FrameTable::at(float S) const
+{
+    if (m_step <= 0.f)
+        return m_frames.front();
+
+    S = std::fmod(S, m_length);
+    if (S < 0.f)
+        S += m_length;
+
+    const size_t i = std::min(static_cast<size_t>(S / m_step), m_frames.size() - 2);
+    return this->interpolate(i, S / m_step - i);
+}
+
+void FrameTable::at_chain(float head_S, const float *offsets, size_t n, Frame *out) const
+{
+    if (m_step <= 0.f) {
+        std::fill(out, out + n, m_frames.front());
+        return;
+    }
+
+    head_S = std::fmod(head_S, m_length);
+    if (head_S < 0.f)
+        head_S += m_length;
+
+    // 表是等距的，每個點可以直接算出在哪一格；往回走時只需要記錄繞過起點幾次，不用每個點都做fmod
+    const size_t cells = m_frames.size() - 1;
+    float lap = 0.f; // 往回繞過起點幾次 * m_length
+    for (size_t k = 0; k < n; ++k) {
+        assert(k == 0 || offsets[k] >= offsets[k - 1]);
+
+        float S = head_S - offsets[k] + lap;
+        while (S < 0.f) {
+            lap += m_length;
+            S += m_length;
+        }
+        const size_t i = std::min(static_cast<size_t>(S / m_step), cells - 1);
+        out[k] = this->interpolate(i, std::min(S / m_step - i, 1.f));
+    }
+}
+
+FrameTable::Frame FrameTable::interpolate(size_t i, float f) const
+{
+    const Frame& a = m_frames[i];
+    const Frame& b = m_frames[i + 1];
+
+    const glm::vec3 FRONT = glm::normalize(a.FRONT + (b.FRONT - a.FRONT) * f);
+    return make_frame(a.pos + (b.pos - a.pos) * f, FRONT, a.TOP + (b.TOP - a.TOP) * f);
+}
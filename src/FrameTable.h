@@ -0,0 +1,81 @@
+/**
+ * @file FrameTable.h
+ * @brief 沿著軌道、以實際距離S等距取樣的座標系表
+ */
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include <glm/vec3.hpp>
+#include <vector>
+#include "TrackCurve.h"
+
+/**
+ * @brief 沿著軌道的座標系表
+ * @details
+ * 每隔固定的實際距離存一個座標系（位置、FRONT、LEFT、TOP）。
+ * 座標系用double reflection法沿著軌道平行移動（rotation-minimizing frame），
+ * 所以在orient幾乎和前進方向平行、無法決定上方時也不會突然翻轉；
+ * orient和前進方向夾角夠大時則跟著控制點的orient，保留使用者設定的傾斜。
+ * 平行移動繞一圈回到起點時通常會差一個角度（holonomy），這個扭轉會沿著S平均分散到整條軌道上，起點處不會突然轉一下。
+ *
+ * 軌道改變後呼叫一次 rebuild()，之後任何S只需要在相鄰兩個座標系間內插一次。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class FrameTable
+{
+public:
+    /// 軌道上某處的座標系，FRONT、LEFT、TOP兩兩垂直且長度為1
+    struct Frame {
+        glm::vec3 pos;
+        glm::vec3 FRONT; ///< 前進的方向
+        glm::vec3 LEFT;  ///< cross(TOP, FRONT)
+        glm::vec3 TOP;   ///< 軌道的上方
+    };
+
+private:
+    std::vector<Frame> m_frames; ///< 第k項為 S = k * m_step 的座標系，最後一項和第0項在同一個位置
+    float m_interval; ///< 取樣間距的上限
+    float m_step;     ///< 實際的取樣間距（整條軌道剛好分成整數段）
+    float m_length;   ///< 軌道的長度
+
+public:
+    /// @param interval - 相鄰兩個座標系的距離上限（實際距離）
+    explicit FrameTable(float interval);
+
+    /**
+     * @brief 依照軌道重建座標系表
+     * @param track - 軌道，至少要有一段曲線
+     */
+    void rebuild(const TrackCurve& track);
+
+    /// 是否還沒建立
+    bool empty() const { return m_frames.empty(); }
+
+    /// 軌道的長度
+    float length() const { return m_length; }
+
+    /**
+     * @brief 實際距離S處的座標系
+     * @param S - 可以是任何值，會先wrap回 [0, length())
+     * @pre !empty()
+     */
+    Frame at(float S) const;
+
+    /**
+     * @brief 一次求出一串在 head_S 後方的座標系（如一列火車的每節車廂）
+     * @details 第k個座標系位於 head_S - offsets[k]。offsets 由小到大，
+     *          所以只需要從 head_S 往回掃一次，只有 head_S 需要wrap，之後的點只在繞過起點時加上 length()。
+     * @param offsets - 和 head_S 的距離，須由小到大且大於等於0
+     * @param n - 座標系的個數
+     * @param[out] out - 至少要有n項
+     * @pre !empty()
+     */
+    void at_chain(float head_S, const float* offsets, size_t n, Frame* out) const;
+
+private:
+    /// 在第i個和第i+1個座標系間內插，f 介於 [0, 1]
+    Frame interpolate(size_t i, float f) const;
+};
+
+#endif // FRAMETABLE_H
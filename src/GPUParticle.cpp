@@ -0,0 +1,210 @@
+#include "GPUParticle.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+GPUParticle::GPUParticle(const std::vector<QString>& layers, size_t capacity)
+    : m_capacity(capacity), m_allocated(0), m_emitters(), m_effects(), m_transforms(), m_effects_dirty(false),
+    m_update_shader("shader/particle_update.comp"), m_uniform_count(m_update_shader.uniform<GLuint>("count")),
+    m_staging(capacity * sizeof(glm::vec4)),
+    m_shader("shader/particle.vert", nullptr, nullptr, nullptr, "shader/particle.frag"), m_atlas(layers)
+{
+    m_shader.uniform<GLint>("img").set(0);
+
+    glBindVertexArray(m_plane_VAO.name());
+
+    glGenBuffers(1, &m_particle_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_particle_buffer);
+    // 只在這裡配置一次，所有粒子的狀態都留在GPU上；一開始每格都是死掉的粒子
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(glm::vec4), NULL, GL_DYNAMIC_DRAW);
+    const glm::vec4 dead(0, 0, 0, -1);
+    glClearBufferData(GL_ARRAY_BUFFER, GL_RGBA32F, GL_RGBA, GL_FLOAT, &dead);
+    // 將 (位置, TTL) 綁在編號2
+    glVertexAttribPointer(2, 4, GL_FLOAT, false, /*stride*/0, (void*)0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1); // 每過一個instance才取一個
+
+    glGenBuffers(1, &m_slot_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_slot_buffer);
+    // 分給發射點時才寫入
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+    // 將特效的編號綁在編號3
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, /*stride*/0, (void*)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenBuffers(1, &m_effect_buffer);
+}
+
+GPUParticle::~GPUParticle()
+{
+    glDeleteBuffers(1, &m_particle_buffer);
+    glDeleteBuffers(1, &m_slot_buffer);
+    glDeleteBuffers(1, &m_effect_buffer);
+}
+
+size_t GPUParticle::add_effect(const Effect& effect)
+{
+    if (effect.layer >= static_cast<GLuint>(m_atlas.layers()))
+        throw std::runtime_error("ERROR::GPU_PARTICLE::LAYER_OUT_OF_RANGE");
+
+    const bool on_CPU = effect.on_CPU || effect.transform;
+    m_effects.push_back({ glm::vec4(effect.velocity, effect.size),
+                          glm::vec4(effect.velocity_per_TTL, static_cast<float>(effect.layer)),
+                          on_CPU ? 1u : 0u, { 0, 0, 0 } });
+
+    // 沒有指定 transform 時，和 particle_update.comp 的移動方式相同
+    if (effect.transform)
+        m_transforms.push_back(effect.transform);
+    else if (on_CPU)
+        m_transforms.push_back(ParticleTransform::combine(ParticleTransform::linear_drift(effect.velocity),
+                                                          ParticleTransform::buoyancy(effect.velocity_per_TTL)));
+    else
+        m_transforms.emplace_back();
+    m_effects_dirty = true;
+    return m_effects.size() - 1;
+}
+
+size_t GPUParticle::add_emitter(size_t effect, size_t capacity)
+{
+    if (effect >= m_effects.size())
+        throw std::runtime_error("ERROR::GPU_PARTICLE::NO_SUCH_EFFECT");
+    if (capacity == 0 || capacity > m_capacity - m_allocated)
+        throw std::runtime_error("ERROR::GPU_PARTICLE::OUT_OF_CAPACITY");
+
+    // 只有在CPU上模擬的發射點需要 pool，它的格子數和 pool 的容量相同
+    m_emitters.push_back({ m_allocated, capacity, 0, {},
+                           effect, ParticlePool(m_effects[effect].on_CPU ? capacity : 0), 0, false });
+
+    const GLuint index = static_cast<GLuint>(effect);
+    glBindBuffer(GL_ARRAY_BUFFER, m_slot_buffer);
+    glClearBufferSubData(GL_ARRAY_BUFFER, GL_R32UI, m_allocated * sizeof(GLuint), capacity * sizeof(GLuint),
+                         GL_RED_INTEGER, GL_UNSIGNED_INT, &index);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_allocated += capacity;
+    return m_emitters.size() - 1;
+}
+
+void GPUParticle::spawn(size_t emitter, glm::vec3 position, unsigned int TTL)
+{
+    if (TTL == 0) return;
+
+    Emitter& e = m_emitters[emitter];
+    if (m_effects[e.effect].on_CPU)
+        e.pool_dirty |= e.pool.add(position, TTL);
+    else
+        e.pending.emplace_back(position, static_cast<float>(TTL));
+}
+
+void GPUParticle::flush()
+{
+    if (m_effects_dirty) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_effect_buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_effects.size() * sizeof(Effect_Block), m_effects.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        m_effects_dirty = false;
+    }
+
+    // 一個發射點一次發射超過容量時，只有最後 capacity 個會留下；
+    // pool 則要寫入活著的粒子，以及上次上傳後死掉的格子
+    size_t total = 0;
+    for (const Emitter& e : m_emitters) {
+        total += std::min(e.pending.size(), e.capacity);
+        if (e.pool_dirty)
+            total += std::max(e.pool.size(), e.uploaded);
+    }
+    if (total == 0) return;
+
+    // 所有發射點的新粒子放在同一塊staging中，再分段複製到各自的格子
+    const StreamBuffer::Allocation a = m_staging.allocate(total * sizeof(glm::vec4));
+    char* dst = static_cast<char*>(a.ptr);
+    GLintptr read_offset = a.offset;
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_staging.name());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_particle_buffer);
+    for (Emitter& e : m_emitters) {
+        if (e.pool_dirty) {
+            // 活著的粒子在前面連續的格子，其後到上次的數量為止標成死掉
+            const size_t n = std::max(e.pool.size(), e.uploaded);
+            glm::vec4* particles = reinterpret_cast<glm::vec4*>(dst);
+            for (size_t i = 0; i < e.pool.size(); ++i)
+                particles[i] = glm::vec4(e.pool.positions()[i], static_cast<float>(e.pool.TTLs()[i]));
+            std::fill(particles + e.pool.size(), particles + n, glm::vec4(0, 0, 0, -1));
+            dst += n * sizeof(glm::vec4);
+
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, read_offset,
+                                e.first * sizeof(glm::vec4), n * sizeof(glm::vec4));
+            read_offset += n * sizeof(glm::vec4);
+            e.uploaded = e.pool.size();
+            e.pool_dirty = false;
+        }
+        if (e.pending.empty()) continue;
+
+        const size_t skip = e.pending.size() > e.capacity ? e.pending.size() - e.capacity : 0;
+        e.next = (e.next + skip) % e.capacity;
+        size_t remain = e.pending.size() - skip;
+        std::memcpy(dst, e.pending.data() + skip, remain * sizeof(glm::vec4));
+        dst += remain * sizeof(glm::vec4);
+
+        while (remain > 0) { // 繞回開頭時分成兩次複製
+            const size_t n = std::min(remain, e.capacity - e.next);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, read_offset,
+                                (e.first + e.next) * sizeof(glm::vec4), n * sizeof(glm::vec4));
+            e.next = (e.next + n) % e.capacity;
+            read_offset += n * sizeof(glm::vec4);
+            remain -= n;
+        }
+        e.pending.clear();
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GPUParticle::update()
+{
+    // 在CPU上模擬的發射點：先刪除死掉的粒子，再一次移動整段
+    for (Emitter& e : m_emitters) {
+        if (!m_effects[e.effect].on_CPU || (e.pool.size() == 0 && e.uploaded == 0)) continue;
+
+        e.pool.step();
+        ParticleTransform::apply(m_transforms[e.effect], e.pool.positions(), e.pool.TTLs(), e.pool.size());
+        e.pool_dirty = true;
+    }
+
+    this->flush();
+    if (m_allocated == 0) return;
+
+    m_uniform_count.set(static_cast<GLuint>(m_allocated));
+    m_update_shader.Use();
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_particle_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_slot_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_effect_buffer);
+    glDispatchCompute(static_cast<GLuint>((m_allocated + Local_Size - 1) / Local_Size), 1, 1);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+    glUseProgram(0);
+
+    // 之後的繪製、下一次update、寫入新粒子都要看到compute shader的結果
+    glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GPUParticle::draw()
+{
+    this->flush();
+    if (m_allocated == 0) return;
+
+    m_shader.Use();
+    m_atlas.bind_to(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_effect_buffer);
+
+    m_plane_VAO.drawInstanced(static_cast<GLsizei>(m_allocated));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, 0);
+    m_atlas.unbind_from(0);
+    glUseProgram(0);
+}
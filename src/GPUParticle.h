@@ -0,0 +1,151 @@
+/**
+ * @file GPUParticle.h
+ * @brief 把所有粒子特效放在一起，在GPU上模擬、一次畫完
+ */
+#ifndef GPUPARTICLE_H
+#define GPUPARTICLE_H
+
+#include <glad/gl.h>
+#include <vector>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <QString>
+
+#include "ParticlePool.h"
+#include "ParticleTransform.h"
+#include <Plane_VAO.h>
+#include <Shader.h>
+#include <StreamBuffer.h>
+#include <qtTextureImage2DArray.h>
+
+/**
+ * @brief 管理所有粒子特效（永遠朝向相機的貼圖）
+ * @details
+ * 所有的貼圖放在一個 texture array 中，所有的粒子放在同一個buffer中，
+ * 所以不論有幾種特效、幾個發射點，都只用一個compute shader更新一次、一次 drawInstanced 畫完。
+ *
+ * - 特效（effect）：粒子的大小、用 texture array 的第幾層、怎麼移動，用 add_effect() 加入
+ * - 發射點（emitter）：在粒子buffer中佔一段固定的格子，用 add_emitter() 加入，用 spawn() 發射粒子
+ *
+ * 每個發射點的格子是固定容量的ring：第k個發射的粒子放在第 k % capacity 格，滿了就覆蓋最舊的粒子。
+ * 死掉的粒子留在原地（TTL < 0），由vertex shader丟到畫面外。
+ *
+ * 特效設定 Effect::on_CPU 或 Effect::transform 時，它的發射點改用 ParticlePool 在CPU上模擬：死掉的粒子立刻被swap-remove，
+ * 活著的粒子永遠是發射點的前 size() 格，每次update用 ParticleTransform::apply 整段移動後上傳，
+ * compute shader會跳過這些格子；池滿時新的粒子會被丟掉。
+ * 每一格記錄它屬於哪個特效（instanced array，同時是compute shader的SSBO），
+ * shader再從特效的SSBO查出大小、層數和移動方式。
+ *
+ * 見 shader/particle_update.comp、shader/particle.vert。
+ */
+class GPUParticle
+{
+public:
+    /// compute shader 的 local_size_x
+    static constexpr GLuint Local_Size = 64;
+
+    /// 一種粒子特效
+    struct Effect {
+        float size;      ///< 顯示粒子貼圖的面要多大（實際大小2size * 2size）
+        GLuint layer;    ///< 用 texture array 的第幾層
+        glm::vec3 velocity = glm::vec3(0);         ///< 每次update移動多少
+        glm::vec3 velocity_per_TTL = glm::vec3(0); ///< TTL每多1，每次update多移動多少
+        bool on_CPU = false; ///< 若為true，粒子存在 ParticlePool 中，在CPU上移動並移除死掉的粒子
+        /// 在CPU上怎麼移動；有設定時一定在CPU上模擬，且不使用 velocity 和 velocity_per_TTL
+        ParticleTransform::Batch transform = nullptr;
+    };
+
+private:
+    /// 特效在SSBO中的格式（std430，struct對齊到16 bytes）
+    struct Effect_Block {
+        glm::vec4 velocity_size;      ///< xyz: velocity，w: size
+        glm::vec4 TTL_velocity_layer; ///< xyz: velocity_per_TTL，w: layer
+        GLuint on_CPU;                ///< 非0時compute shader不更新
+        GLuint padding[3];
+    };
+
+    struct Emitter {
+        size_t first;     ///< 第一格
+        size_t capacity;  ///< 有幾格
+        size_t next;      ///< 下一個粒子放在第 first + next 格
+        std::vector<glm::vec4> pending; ///< 發射了但還沒寫進buffer的粒子
+
+        size_t effect;     ///< 特效的編號
+        ParticlePool pool; ///< 特效在CPU上模擬時存放粒子；否則容量為0
+        size_t uploaded;   ///< 上次上傳時 pool 有幾個粒子（之後的格子要標成死掉）
+        bool pool_dirty;   ///< pool 改變後還沒上傳
+    };
+
+    size_t m_capacity;  ///< 所有發射點加起來最多有幾格
+    size_t m_allocated; ///< 已經分給發射點的格子數（之後的格子不需要更新或繪製）
+    std::vector<Emitter> m_emitters;
+    std::vector<Effect_Block> m_effects;
+    std::vector<ParticleTransform::Batch> m_transforms; ///< 每個在CPU上模擬的特效怎麼移動；其他特效為空
+    bool m_effects_dirty; ///< m_effects 改變後還沒上傳
+
+    Shader m_update_shader;
+    Shader::Uniform<GLuint> m_uniform_count;
+
+    Plane_VAO m_plane_VAO;    ///< 繪製平面
+    GLuint m_particle_buffer; ///< 每格的 (位置, TTL)，同時是compute shader的SSBO和vertex shader的instanced array
+    GLuint m_slot_buffer;     ///< 每格屬於哪個特效，同時是SSBO和instanced array
+    GLuint m_effect_buffer;   ///< 所有特效（Effect_Block）的SSBO
+    StreamBuffer m_staging;   ///< 上傳新粒子用
+
+    Shader m_shader;
+    qtTextureImage2DArray m_atlas;
+
+public:
+    /**
+     * @brief 建構子
+     * @param layers - texture array 每一層的圖片路徑
+     * @param capacity - 所有發射點加起來最多有幾格
+     */
+    GPUParticle(const std::vector<QString>& layers, size_t capacity);
+
+    /// 呼叫 glDeleteBuffers
+    ~GPUParticle();
+
+    GPUParticle(const GPUParticle&) = delete;
+    GPUParticle& operator=(const GPUParticle&) = delete;
+
+    /**
+     * @brief 加入一種特效
+     * @return 特效的編號
+     * @throw std::runtime_error - 若 effect.layer 超出 texture array 的層數
+     */
+    size_t add_effect(const Effect& effect);
+
+    /**
+     * @brief 加入一個發射點
+     * @param effect - add_effect() 回傳的編號
+     * @param capacity - 這個發射點最多同時有幾個粒子
+     * @return 發射點的編號
+     * @throw std::runtime_error - 若特效不存在或剩下的格子不夠
+     */
+    size_t add_emitter(size_t effect, size_t capacity);
+
+    /**
+     * @brief 從發射點發射一個粒子，如果TTL是0則不會發射
+     * @details 在CPU上模擬的發射點滿了時，新的粒子會被丟掉
+     * @param emitter - add_emitter() 回傳的編號
+     * @param position - 位置
+     * @param TTL - 可以活過幾次update
+     */
+    void spawn(size_t emitter, glm::vec3 position, unsigned TTL);
+
+    /**
+     * @brief 使每個粒子的TTL減一，並依照它的特效移動；TTL為0的粒子會死掉
+     * @details 在CPU上模擬的發射點先更新 ParticlePool，其他的粒子用compute shader更新
+     */
+    void update();
+
+    /// 一次繪製所有粒子
+    void draw();
+
+private:
+    /// 把所有發射點的 pending、改變了的 pool 和特效寫進buffer
+    void flush();
+};
+
+#endif // GPUPARTICLE_H
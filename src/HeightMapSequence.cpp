@@ -0,0 +1,102 @@
+#include "HeightMapSequence.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+HeightMapSequence::HeightMapSequence(const QString& path_pattern, size_t count)
+    : m_paths(), m_array(), m_loaded(count, false), m_loaded_num(0),
+    m_mutex(), m_decoded(), m_next_decode(0), m_stop(false), m_workers()
+{
+    m_paths.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        m_paths.push_back(path_pattern.arg(static_cast<qulonglong>(i), 3, 10, QChar('0')));
+}
+
+HeightMapSequence::~HeightMapSequence()
+{
+    m_stop = true;
+    for (std::thread& th : m_workers)
+        th.join();
+}
+
+void HeightMapSequence::decode()
+{
+    while (!m_stop) {
+        const size_t i = m_next_decode++;
+        if (i >= m_paths.size())
+            return;
+
+        QImage img(m_paths[i]);
+        if (img.isNull()) {
+            std::cerr << "ERROR::HEIGHT_MAP_SEQUENCE::FAIL_TO_OPEN " << qPrintable(m_paths[i]) << std::endl;
+            continue;
+        }
+        // 格式轉換也在背景做，上傳時只剩翻轉和複製
+        img = img.convertToFormat(QImage::Format_Grayscale8);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_decoded.emplace_back(i, std::move(img));
+    }
+}
+
+void HeightMapSequence::upload_decoded()
+{
+    std::vector<std::pair<size_t, QImage>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t n = std::min(m_decoded.size(), Max_Uploads_Per_Call);
+        std::move(m_decoded.begin(), m_decoded.begin() + n, std::back_inserter(ready));
+        m_decoded.erase(m_decoded.begin(), m_decoded.begin() + n);
+    }
+
+    for (const auto& [i, img] : ready) {
+        if (!m_array)
+            m_array = std::make_unique<qtTextureImage2DArray>(img.width(), img.height(),
+                                                             static_cast<GLsizei>(m_paths.size()), GL_R8);
+        m_array->set_layer(static_cast<GLsizei>(i), img);
+        m_loaded[i] = true;
+        ++m_loaded_num;
+    }
+}
+
+int HeightMapSequence::acquire(size_t frame)
+{
+    if (m_workers.empty() && !m_paths.empty()) {
+        const unsigned thread_num = std::min(std::max(1u, std::thread::hardware_concurrency()), Max_Decode_Threads);
+        for (unsigned k = 0; k < thread_num; ++k)
+            m_workers.emplace_back(&HeightMapSequence::decode, this);
+    }
+
+    if (m_loaded_num < m_paths.size())
+        this->upload_decoded();
+    if (m_loaded_num == 0)
+        return -1;
+
+    // 從frame往前後找最接近的已載入的幀（循環播放，所以頭尾相接）
+    const size_t n = m_paths.size();
+    frame %= n;
+    for (size_t d = 0; d <= n / 2; ++d) {
+        if (m_loaded[(frame + d) % n])
+            return static_cast<int>((frame + d) % n);
+        if (m_loaded[(frame + n - d) % n])
+            return static_cast<int>((frame + n - d) % n);
+    }
+    return -1;
+}
+
+void HeightMapSequence::bind_to(GLuint sampler)
+{
+    if (m_array) {
+        m_array->bind_to(sampler);
+    }
+    else {
+        glActiveTexture(GL_TEXTURE0 + sampler);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+}
+
+void HeightMapSequence::unbind_from(GLuint sampler)
+{
+    glActiveTexture(GL_TEXTURE0 + sampler);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
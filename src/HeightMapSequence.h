@@ -0,0 +1,90 @@
+/**
+ * @file HeightMapSequence.h
+ * @brief 連續播放的height map，在背景載入到一個texture array
+ */
+#ifndef HEIGHTMAPSEQUENCE_H
+#define HEIGHTMAPSEQUENCE_H
+
+#include <glad/gl.h>
+#include <QImage>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <qtTextureImage2DArray.h>
+
+/**
+ * @brief 一連串的height map（每一幀一張圖），放在一個 GL_R8 的 texture array 中
+ * @details
+ * 建構時不讀任何圖，也不配置texture；第一次呼叫 acquire() 時才開始在背景執行緒解碼，
+ * 之後每次 acquire() 最多把 Max_Uploads_Per_Call 張已解碼的圖上傳到texture array（在呼叫的執行緒，也就是有OpenGL context的執行緒）。
+ * 還沒載入的幀用最接近的已載入的幀代替（依照播放順序循環計算距離）。
+ *
+ * texture array 在第一張圖解碼完成後，以它的大小配置。無法開啟的圖會印出錯誤並跳過，那一幀也用最接近的幀代替。
+ */
+class HeightMapSequence
+{
+public:
+    /// 每次 acquire() 最多上傳幾張圖
+    static constexpr size_t Max_Uploads_Per_Call = 8;
+    /// 最多幾個解碼的執行緒
+    static constexpr unsigned Max_Decode_Threads = 4;
+
+private:
+    std::vector<QString> m_paths; ///< 每一幀的圖片路徑
+
+    std::unique_ptr<qtTextureImage2DArray> m_array; ///< 第一張圖上傳時才配置
+    std::vector<bool> m_loaded; ///< 每一幀是否已經上傳
+    size_t m_loaded_num;        ///< 已經上傳了幾幀
+
+    // 以下和解碼的執行緒共用
+    std::mutex m_mutex;
+    std::vector<std::pair<size_t, QImage>> m_decoded; ///< 已解碼、還沒上傳的圖（受 m_mutex 保護）
+    std::atomic<size_t> m_next_decode; ///< 下一個要解碼的幀
+    std::atomic<bool> m_stop;          ///< 要求解碼的執行緒結束
+    std::vector<std::thread> m_workers;
+
+public:
+    /**
+     * @brief 建構子，不會讀任何圖
+     * @param path_pattern - 圖片路徑，"%1" 會被換成3位數的幀號（000、001、...）
+     * @param count - 幾幀
+     */
+    HeightMapSequence(const QString& path_pattern, size_t count);
+
+    /// 停止並等待解碼的執行緒
+    ~HeightMapSequence();
+
+    HeightMapSequence(const HeightMapSequence&) = delete;
+    HeightMapSequence& operator=(const HeightMapSequence&) = delete;
+
+    /// 幾幀
+    size_t size() const { return m_paths.size(); }
+
+    /**
+     * @brief 取得要顯示 frame 時該用 texture array 的第幾層
+     * @details 第一次呼叫時開始在背景解碼；每次呼叫都會上傳一些已解碼的圖
+     * @note 要makeCurrent
+     * @return 最接近 frame 的已載入的層；還沒有任何一幀載入時回傳-1
+     */
+    int acquire(size_t frame);
+
+    /// 綁定 texture array 到特定sampler（還沒配置時綁定0）
+    void bind_to(GLuint sampler);
+
+    /// 從特定sampler解除綁定
+    void unbind_from(GLuint sampler);
+
+private:
+    /// 解碼的執行緒：依序領取還沒解碼的幀，直到全部解碼完或 m_stop
+    void decode();
+
+    /// 上傳最多 Max_Uploads_Per_Call 張已解碼的圖
+    void upload_decoded();
+};
+
+#endif // HEIGHTMAPSEQUENCE_H
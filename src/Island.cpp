@@ -2,12 +2,17 @@
 #include "Island.h"
 
 Island::Island()
-    : m_shader("shader/model.vert", nullptr, nullptr, nullptr, "shader/model.frag"), m_model("asset/model/island/Island.fbx"),
+    : m_shader("shader/model.vert", nullptr, nullptr, nullptr, "shader/model.frag"),
+    m_uniform_has_texture(m_shader.uniform<GLint>("has_texture")), m_model("asset/model/island/Island.fbx"),
     m_tree_model("asset/model/tree/JASMIM+MANGA.obj"), m_house_model("asset/model/house/house.obj")
 {
-    m_shader.Use();
-    glUniform1i(glGetUniformLocation(m_shader.Program, "diffuse_texture"), 0);
-    glUseProgram(0);
+    m_shader.uniform<GLint>("diffuse_texture").set(0);
+
+    std::vector<glm::vec3> triangles;
+    m_model.append_triangles(triangles);
+    m_tree_model.append_triangles(triangles);
+    m_house_model.append_triangles(triangles);
+    m_bvh = TriangleBVH(std::move(triangles));
 }
 
 void Island::draw(bool wireframe)
@@ -15,10 +20,10 @@ void Island::draw(bool wireframe)
     glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
     m_shader.Use();
 
-    glUniform1i(glGetUniformLocation(m_shader.Program, "has_texture"), false);
+    m_uniform_has_texture.set(false);
     m_model.draw();
 
-    glUniform1i(glGetUniformLocation(m_shader.Program, "has_texture"), true);
+    m_uniform_has_texture.set(true);
     m_tree_model.draw();
     m_house_model.draw();
 
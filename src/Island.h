@@ -4,20 +4,26 @@
 
 #include "Shader.h"
 #include "Model.h"
+#include "RayCast.h"
 
 
 class Island
 {
 private:
     Shader m_shader;
+    Shader::Uniform<GLint> m_uniform_has_texture;
     Model m_model;
     Model m_tree_model;
     Model m_house_model;
+    TriangleBVH m_bvh; ///< 所有模型的三角形，用來在CPU上點擊
 
 public:
     Island();
 
     void draw(bool wireframe);
+
+    /// 射線和島（包含樹和房子）最近的交點的 t；沒有打到時回傳 RayCast::No_Hit
+    float ray_cast(const Ray& ray) const { return m_bvh.intersect(ray); }
 };
 
 #endif // ISLAND_H
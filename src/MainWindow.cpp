@@ -68,12 +68,21 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->radioCardinal, &QRadioButton::clicked, this, [this]() {
         ui->view->get_train().set_line_type(SplineType::CARDINAL);
     });
+    connect(ui->checkBoxExtraPillars, &QCheckBox::toggled, this, [this](bool on) {
+        ui->view->get_train().toggle_extra_pillars(on);
+    });
 
     // Train: 火車
     connect(ui->checkBoxTrackingTrain, &QCheckBox::toggled, ui->view, &ViewWidget::toggle_tracking_train);
     connect(ui->buttonAddCart, &QPushButton::clicked, this, [this]() { ui->view->get_train().add_cart(); });
     connect(ui->buttonDeleteCart, &QPushButton::clicked, this, [this]() { ui->view->get_train().delete_cart(); });
     connect(ui->buttonClearCart, &QPushButton::clicked, this, [this]() { ui->view->get_train().clear_cart(); });
+    connect(ui->buttonAddTrain, &QPushButton::clicked, this, [this]() { ui->view->get_train().add_train(); });
+    connect(ui->buttonDeleteTrain, &QPushButton::clicked, this, [this]() { ui->view->get_train().delete_train(); });
+    connect(ui->checkBoxPhysics, &QCheckBox::toggled, this, [this](bool on) { ui->view->get_train().toggle_physics(on); });
+    connect(ui->view, &ViewWidget::lap_time_changed, this, [this](float seconds) {
+        ui->labelLapTime->setText(seconds > 0.f ? QString::number(seconds, 'f', 1) + " s" : QString("-"));
+    });
     connect(ui->sliderSpeed, &QSlider::valueChanged, ui->view, &ViewWidget::set_train_speed);
 
     // Misc
@@ -6,56 +6,182 @@
  *********************************************************************/
 #include "ParamEquation.h"
 #include <math.h>
+#include <algorithm>
+#include <thread>
 #include <glm/gtc/type_ptr.hpp>
 
+// SIMD ///////////////////////////////////////////////////////////////////////////
+
+// 依編譯器的目標指令集選擇一次算幾個點；沒有SSE時退回純量
+#if defined(__AVX__)
+#include <immintrin.h>
+#define DRAW_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DRAW_SIMD_WIDTH 4
+#else
+#define DRAW_SIMD_WIDTH 1
+#endif
+
+namespace {
+
+#if DRAW_SIMD_WIDTH == 8
+	typedef __m256 Lane;
+	inline Lane lane_set1(float v) { return _mm256_set1_ps(v); }
+	inline Lane lane_load(const float* p) { return _mm256_loadu_ps(p); }
+	inline void lane_store(float* p, Lane v) { _mm256_storeu_ps(p, v); }
+	inline Lane lane_add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+	inline Lane lane_mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+	inline Lane lane_sqrt(Lane a) { return _mm256_sqrt_ps(a); }
+#elif DRAW_SIMD_WIDTH == 4
+	typedef __m128 Lane;
+	inline Lane lane_set1(float v) { return _mm_set1_ps(v); }
+	inline Lane lane_load(const float* p) { return _mm_loadu_ps(p); }
+	inline void lane_store(float* p, Lane v) { _mm_storeu_ps(p, v); }
+	inline Lane lane_add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+	inline Lane lane_mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+	inline Lane lane_sqrt(Lane a) { return _mm_sqrt_ps(a); }
+#else
+	typedef float Lane;
+	inline Lane lane_set1(float v) { return v; }
+	inline Lane lane_load(const float* p) { return *p; }
+	inline void lane_store(float* p, Lane v) { *p = v; }
+	inline Lane lane_add(Lane a, Lane b) { return a + b; }
+	inline Lane lane_mul(Lane a, Lane b) { return a * b; }
+	inline Lane lane_sqrt(Lane a) { return sqrtf(a); }
+#endif
+
+	/// 一個分量的三次多項式，係數已複製到每個lane
+	struct Cubic_Lanes {
+		Lane c0, c1, c2, c3;
+
+		Cubic_Lanes(float _c0, float _c1, float _c2, float _c3)
+			: c0(lane_set1(_c0)), c1(lane_set1(_c1)), c2(lane_set1(_c2)), c3(lane_set1(_c3))
+		{
+		}
+
+		/// Horner法
+		Lane operator()(Lane t) const { return lane_add(lane_mul(lane_add(lane_mul(lane_add(lane_mul(c3, t), c2), t), c1), t), c0); }
+	};
+
+	/// 點的三個分量
+	struct Segment_Lanes {
+		Cubic_Lanes x, y, z;
+
+		/// 點
+		explicit Segment_Lanes(const Draw::Cubic_Segment& seg)
+			: x(seg.c0.x, seg.c1.x, seg.c2.x, seg.c3.x),
+			  y(seg.c0.y, seg.c1.y, seg.c2.y, seg.c3.y),
+			  z(seg.c0.z, seg.c1.z, seg.c2.z, seg.c3.z)
+		{
+		}
+
+		/// 微分：c1 + 2 c2 t + 3 c3 t^2
+		static Segment_Lanes derivative(const Draw::Cubic_Segment& seg) {
+			return Segment_Lanes(Draw::Cubic_Segment{ seg.c1, 2.f * seg.c2, 3.f * seg.c3, glm::vec3(0.f) });
+		}
+	};
+
+	/// 用 lanes 求 t[0] ~ t[n-1]，最後不足一個lane的用 scalar 算
+	template<typename Scalar>
+	void batch(const Segment_Lanes& lanes, Scalar scalar, const float* t, size_t n, float* x, float* y, float* z) {
+		size_t k = 0;
+		for (; k + DRAW_SIMD_WIDTH <= n; k += DRAW_SIMD_WIDTH) {
+			const Lane T = lane_load(t + k);
+			lane_store(x + k, lanes.x(T));
+			lane_store(y + k, lanes.y(T));
+			lane_store(z + k, lanes.z(T));
+		}
+		for (; k < n; ++k) {
+			const glm::vec3 p = scalar(t[k]);
+			x[k] = p.x; y[k] = p.y; z[k] = p.z;
+		}
+	}
+
+	/// 總點數超過這個值時，evaluate_segments 才用多個執行緒
+	constexpr size_t PARALLEL_POINTS = 1 << 15;
+
+} // namespace
+
+void Draw::evaluate_batch(const Cubic_Segment& segment, const float* t, size_t n, float* x, float* y, float* z) {
+	batch(Segment_Lanes(segment), segment, t, n, x, y, z);
+}
+
+void Draw::evaluate_derivative_batch(const Cubic_Segment& segment, const float* t, size_t n, float* x, float* y, float* z) {
+	batch(Segment_Lanes::derivative(segment), [&segment](float t) { return segment.derivative(t); }, t, n, x, y, z);
+}
+
+void Draw::evaluate_speed_batch(const Cubic_Segment& segment, const float* t, size_t n, float* speed) {
+	const Segment_Lanes lanes = Segment_Lanes::derivative(segment);
+
+	size_t k = 0;
+	for (; k + DRAW_SIMD_WIDTH <= n; k += DRAW_SIMD_WIDTH) {
+		const Lane T = lane_load(t + k);
+		const Lane dx = lanes.x(T), dy = lanes.y(T), dz = lanes.z(T);
+		lane_store(speed + k, lane_sqrt(lane_add(lane_add(lane_mul(dx, dx), lane_mul(dy, dy)), lane_mul(dz, dz))));
+	}
+	for (; k < n; ++k) {
+		const glm::vec3 d = segment.derivative(t[k]);
+		speed[k] = sqrtf(d.x * d.x + d.y * d.y + d.z * d.z);
+	}
+}
+
+void Draw::evaluate_segments(const Cubic_Segment* segments, size_t segment_num, const float* t, size_t n, Points_SoA& out) {
+	out.resize(segment_num * n);
+
+	// 計算第 [begin, end) 段
+	auto work = [segments, t, n, &out](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			evaluate_batch(segments[i], t, n, out.x.data() + i * n, out.y.data() + i * n, out.z.data() + i * n);
+	};
+
+	const size_t thread_num = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), segment_num);
+	if (segment_num * n < PARALLEL_POINTS || thread_num <= 1) {
+		work(0, segment_num);
+		return;
+	}
+
+	// 每個執行緒負責連續的幾段，寫入的範圍不會重疊
+	std::vector<std::thread> threads;
+	threads.reserve(thread_num - 1);
+	const size_t per_thread = (segment_num + thread_num - 1) / thread_num;
+	for (size_t begin = per_thread; begin < segment_num; begin += per_thread)
+		threads.emplace_back(work, begin, std::min(begin + per_thread, segment_num));
+	work(0, per_thread);
+
+	for (std::thread& th : threads)
+		th.join();
+}
+
+Draw::Cubic_Segment Draw::make_segment(SplineType type, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float tension) {
+	switch (type) {
+	case SplineType::LINEAR:
+		return make_segment<SplineType::LINEAR>(p0, p1, p2, p3, tension);
+	case SplineType::CARDINAL:
+		return make_segment<SplineType::CARDINAL>(p0, p1, p2, p3, tension);
+	case SplineType::CUBIC_B:
+	default:
+		return make_segment<SplineType::CUBIC_B>(p0, p1, p2, p3, tension);
+	}
+}
+
 Draw::Param_Equation Draw::make_line(const glm::vec3 p1, const glm::vec3 p2) {
-    return [p1, p2](float t) -> glm::vec3 {
-		return (1.f - t) * p1 + t * p2;
+	const Cubic_Segment seg = make_segment<SplineType::LINEAR>(p1, p1, p2, p2, 0.f);
+    return [seg](float t) -> glm::vec3 {
+		return seg(t);
 	};
 }
 
 Draw::Param_Equation Draw::make_cubic_b_spline(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3) {
-	static const glm::mat4 M (
-		-1 / 6.f,  3 / 6.f, -3 / 6.f, 1 / 6.f, // first column
-		 3 / 6.f, -6 / 6.f,  3 / 6.f,    0,    // second column
-		-3 / 6.f,    0    ,  3 / 6.f,    0,    // third column
-		 1 / 6.f,  4 / 6.f,  1 / 6.f,    0     // forth column
-	);
-
-	// 4 columns and 3 rows
-	glm::mat4x3 G(
-        p0, // first column
-        p1, // second column
-        p2, // third column
-        p3  // forth column
-	);
-
-    return [G](float t) -> glm::vec3 {
-		glm::vec4 T(t * t * t, t * t, t, 1);
-		glm::vec3 Q = G * M * T;
-        return Q;
+	const Cubic_Segment seg = make_segment<SplineType::CUBIC_B>(p0, p1, p2, p3, 0.f);
+    return [seg](float t) -> glm::vec3 {
+		return seg(t);
 	};
 }
 
 Draw::Param_Equation Draw::make_cardinal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float tension) {
-	const glm::mat4 M(
-           -tension,  2 - tension,      tension - 2,   tension,  // first column
-        2 * tension,  tension - 3,  3 - 2 * tension,  -tension,  // second column
-           -tension,            0,          tension,         0,  // third column
-                  0,            1,          0,               0   // forth column
-	);
-
-	// 4 columns and 3 rows
-	glm::mat4x3 G(
-        p0, // first column
-        p1, // second column
-        p2, // third column
-        p3  // forth column
-	);
-
-    return [G, M](float t) -> glm::vec3 {
-		glm::vec4 T(t * t * t, t * t, t, 1);
-		glm::vec3 Q = G * M * T;
-        return Q;
+	const Cubic_Segment seg = make_segment<SplineType::CARDINAL>(p0, p1, p2, p3, tension);
+    return [seg](float t) -> glm::vec3 {
+		return seg(t);
 	};
 }
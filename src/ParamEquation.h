@@ -6,8 +6,17 @@
  *********************************************************************/
 #pragma once
 #include <functional>
+#include <vector>
+#include <cstddef>
 #include <glm/vec3.hpp>
 
+/// 火車用的軌道樣式
+enum class SplineType {
+    LINEAR,   ///< 直線
+    CARDINAL, ///< cardinal
+    CUBIC_B   ///< cubic B spline
+};
+
 /// @brief 參數式
 namespace Draw {
 
@@ -15,6 +24,113 @@ namespace Draw {
 	/// @details 參數 - 參數式的t， 回傳 - 點
     typedef std::function<glm::vec3(float)> Param_Equation;
 
+	/**
+	 * @brief 用三次多項式表示的一段曲線：P(t) = c0 + c1 * t + c2 * t^2 + c3 * t^3
+	 * @details
+	 * 係數在建立時就算好（也就是 G * M 的結果），之後每次求值只需要用Horner法做三次乘加，
+	 * 不需要配置記憶體，也不會經過 std::function 的間接呼叫。
+	 */
+	struct Cubic_Segment {
+		glm::vec3 c0; ///< 常數項
+		glm::vec3 c1; ///< t 的係數
+		glm::vec3 c2; ///< t^2 的係數
+		glm::vec3 c3; ///< t^3 的係數
+
+		/// 求 t 時的點
+		glm::vec3 operator()(float t) const { return ((c3 * t + c2) * t + c1) * t + c0; }
+
+		/// 求 t 時對t的微分
+		glm::vec3 derivative(float t) const { return (3.f * c3 * t + 2.f * c2) * t + c1; }
+	};
+
+	/**
+	 * @brief 依照spline的種類建立一段曲線，在編譯時期決定要用哪個基底
+	 * @details
+	 * - SplineType::LINEAR - 從 p1 到 p2 的直線，p0、p3 和 tension 不會用到
+	 * - SplineType::CARDINAL - 以 tension 為張力的cardinal spline
+	 * - SplineType::CUBIC_B - cubic B-spline，tension 不會用到
+	 * @param p0 - 更後面的控制點
+	 * @param p1 - 開始（t=0）
+	 * @param p2 - 結束（t=1）
+	 * @param p3 - 更前面的控制點
+	 * @param tension - cardinal spline的張力
+	 */
+	template<SplineType type>
+	Cubic_Segment make_segment(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float tension);
+
+	template<>
+	inline Cubic_Segment make_segment<SplineType::LINEAR>(const glm::vec3&, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3&, float) {
+		return Cubic_Segment{ p1, p2 - p1, glm::vec3(0), glm::vec3(0) };
+	}
+
+	template<>
+	inline Cubic_Segment make_segment<SplineType::CARDINAL>(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float tension) {
+		return Cubic_Segment{
+			p1,
+			tension * (p2 - p0),
+			2 * tension * p0 + (tension - 3) * p1 + (3 - 2 * tension) * p2 - tension * p3,
+			-tension * p0 + (2 - tension) * p1 + (tension - 2) * p2 + tension * p3
+		};
+	}
+
+	template<>
+	inline Cubic_Segment make_segment<SplineType::CUBIC_B>(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float) {
+		return Cubic_Segment{
+			(p0 + 4.f * p1 + p2) / 6.f,
+			(p2 - p0) / 2.f,
+			(p0 - 2.f * p1 + p2) / 2.f,
+			(-p0 + 3.f * p1 - 3.f * p2 + p3) / 6.f
+		};
+	}
+
+	/// @brief 同 make_segment<type>()，但spline的種類在執行時期才決定
+	Cubic_Segment make_segment(SplineType type, const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float tension);
+
+	/// @name 批次求值
+	/// @brief 一次對很多個t求值，結果用structure of arrays存放，有SSE或AVX時一次算4或8個點
+	/// @{
+
+	/// 用structure of arrays存放的一堆點，第i個點為 (x[i], y[i], z[i])
+	struct Points_SoA {
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+
+		/// 改變點的數量
+		void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+
+		/// 點的數量
+		size_t size() const { return x.size(); }
+
+		/// 取出第i個點
+		glm::vec3 operator[](size_t i) const { return glm::vec3(x[i], y[i], z[i]); }
+	};
+
+	/**
+	 * @brief 求 segment 在 t[0] ~ t[n-1] 的點
+	 * @param[out] x, y, z - 至少要有n項，第k個點寫到 x[k], y[k], z[k]
+	 */
+	void evaluate_batch(const Cubic_Segment& segment, const float* t, size_t n, float* x, float* y, float* z);
+
+	/// @brief 同 evaluate_batch()，但求的是對t的微分
+	void evaluate_derivative_batch(const Cubic_Segment& segment, const float* t, size_t n, float* x, float* y, float* z);
+
+	/**
+	 * @brief 求 segment 在 t[0] ~ t[n-1] 的速率 |dP/dt|
+	 * @param[out] speed - 至少要有n項
+	 */
+	void evaluate_speed_batch(const Cubic_Segment& segment, const float* t, size_t n, float* speed);
+
+	/**
+	 * @brief 對很多段曲線，在同一組 t[0] ~ t[n-1] 上求值
+	 * @details 第i段曲線在t[k]的點寫到 out 的第 i * n + k 項。
+	 *          總點數很多時（很長的軌道）會把各段曲線分給多個執行緒計算。
+	 * @param[out] out - 會被resize成 segment_num * n 項
+	 */
+	void evaluate_segments(const Cubic_Segment* segments, size_t segment_num, const float* t, size_t n, Points_SoA& out);
+
+	/// @}
+
 	/// @brief 建立一個直線的參數式
 	/// @param p1 - t=0 時的點
 	/// @param p2 - t=1 時的點
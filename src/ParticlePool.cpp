@@ -0,0 +1,33 @@
+#include "ParticlePool.h"
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_positions(capacity), m_TTLs(capacity), m_size(0)
+{
+}
+
+bool ParticlePool::add(const glm::vec3 &position, unsigned TTL)
+{
+    if (TTL == 0 || m_size == m_positions.size())
+        return false;
+
+    m_positions[m_size] = position;
+    m_TTLs[m_size] = TTL;
+    ++m_size;
+    return true;
+}
+
+void ParticlePool::step()
+{
+    for (size_t i = 0; i < m_size; ) {
+        if (m_TTLs[i] == 0) {
+            // 用最後一個粒子補上，i 不需遞增
+            --m_size;
+            m_positions[i] = m_positions[m_size];
+            m_TTLs[i] = m_TTLs[m_size];
+        }
+        else {
+            --m_TTLs[i];
+            ++i;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file ParticlePool.h
+ * @brief 固定容量的粒子池
+ */
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include <glm/vec3.hpp>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 固定容量的粒子池
+ * @details
+ * 以structure of arrays存放每個粒子的位置和TTL，前 size() 項為活著的粒子。
+ * 所有記憶體在建構時就配置好，之後 add() 和 update() 都不會再配置記憶體；池滿時新的粒子會被丟掉。
+ *
+ * 刪除粒子時把最後一個粒子搬到它的位置（swap-remove），所以一次死掉很多粒子也只要O(n)，但粒子的順序會改變。
+ * 位置是連續的 glm::vec3 陣列，可以直接整塊上傳到instance buffer。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class ParticlePool
+{
+private:
+    std::vector<glm::vec3> m_positions; ///< 每個粒子的位置，大小固定為容量
+    std::vector<unsigned> m_TTLs;       ///< 每個粒子的TTL，大小固定為容量
+    size_t m_size;                      ///< 活著的粒子數
+
+public:
+    /// @param capacity - 最多同時有幾個粒子
+    explicit ParticlePool(size_t capacity);
+
+    /// 最多同時有幾個粒子
+    size_t capacity() const { return m_positions.size(); }
+
+    /// 活著的粒子數
+    size_t size() const { return m_size; }
+
+    /// 前 size() 項為活著的粒子的位置
+    const glm::vec3* positions() const { return m_positions.data(); }
+
+    /// 前 size() 項為活著的粒子的位置，可以直接修改（例如交給 ParticleTransform::apply）
+    glm::vec3* positions() { return m_positions.data(); }
+
+    /// 前 size() 項為活著的粒子的TTL
+    const unsigned* TTLs() const { return m_TTLs.data(); }
+
+    /**
+     * @brief 新增一個粒子
+     * @param TTL - 可以活過幾次update，0則不會新增
+     * @return 是否新增（TTL為0或池滿時回傳false）
+     */
+    bool add(const glm::vec3& position, unsigned TTL);
+
+    /// 刪除所有粒子
+    void clear() { m_size = 0; }
+
+    /**
+     * @brief 刪除TTL已經是0的粒子，並使其他粒子的TTL減一
+     * @details 只做這一步，位置之後再一次整段改變（見 ParticleTransform）
+     */
+    void step();
+
+    /**
+     * @brief 使每個粒子的TTL減一，再用 transform 改變它的位置；呼叫時TTL已經是0的粒子會被刪除
+     * @param transform - 以 (舊位置, 減一後的TTL) 為參數、回傳新位置的函式
+     */
+    template <class F>
+    void update(F transform)
+    {
+        this->step();
+        for (size_t i = 0; i < m_size; ++i)
+            m_positions[i] = transform(m_positions[i], m_TTLs[i]);
+    }
+};
+
+#endif // PARTICLEPOOL_H
@@ -0,0 +1,71 @@
+#include "ParticleTransform.h"
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ParticleTransform {
+
+Batch linear_drift(const glm::vec3& velocity)
+{
+    return [velocity](glm::vec3* positions, const unsigned*, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            positions[i] += velocity;
+    };
+}
+
+Batch buoyancy(const glm::vec3& rise_per_TTL)
+{
+    return [rise_per_TTL](glm::vec3* positions, const unsigned* TTLs, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            positions[i] += static_cast<float>(TTLs[i]) * rise_per_TTL;
+    };
+}
+
+Batch wind(const glm::vec3& velocity, float reference_height)
+{
+    const glm::vec3 per_height = velocity / reference_height;
+    return [per_height](glm::vec3* positions, const unsigned*, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            positions[i] += std::max(positions[i].y, 0.f) * per_height;
+    };
+}
+
+Batch combine(Batch first, Batch second)
+{
+    return [first = std::move(first), second = std::move(second)](glm::vec3* positions, const unsigned* TTLs, size_t n) {
+        first(positions, TTLs, n);
+        second(positions, TTLs, n);
+    };
+}
+
+Batch per_particle(std::function<glm::vec3(const glm::vec3&, unsigned)> transform)
+{
+    return [transform = std::move(transform)](glm::vec3* positions, const unsigned* TTLs, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            positions[i] = transform(positions[i], TTLs[i]);
+    };
+}
+
+void apply(const Batch& transform, glm::vec3* positions, const unsigned* TTLs, size_t n)
+{
+    const size_t thread_num = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                               n / Parallel_Particles + 1);
+    if (n < Parallel_Particles || thread_num <= 1) {
+        transform(positions, TTLs, n);
+        return;
+    }
+
+    // 每個執行緒負責連續的一段，寫入的範圍不會重疊
+    std::vector<std::thread> threads;
+    threads.reserve(thread_num - 1);
+    const size_t per_thread = (n + thread_num - 1) / thread_num;
+    for (size_t begin = per_thread; begin < n; begin += per_thread)
+        threads.emplace_back(std::cref(transform), positions + begin, TTLs + begin, std::min(per_thread, n - begin));
+    transform(positions, TTLs, per_thread);
+
+    for (std::thread& th : threads)
+        th.join();
+}
+
+}
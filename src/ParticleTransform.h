@@ -0,0 +1,64 @@
+/**
+ * @file ParticleTransform.h
+ * @brief 一次改變一整段粒子位置的函式
+ */
+#ifndef PARTICLETRANSFORM_H
+#define PARTICLETRANSFORM_H
+
+#include <glm/vec3.hpp>
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief 一次改變一整段粒子的位置（batch transformer）
+ * @details
+ * 和每個粒子呼叫一次 std::function 不同，Batch 每段只呼叫一次，內部是沒有間接呼叫的迴圈，編譯器可以向量化。
+ * apply() 在粒子很多時把整段切開，分給多個執行緒。
+ *
+ * 這裡的函式不會呼叫任何OpenGL或Qt的函式。
+ */
+namespace ParticleTransform {
+
+/**
+ * @brief 改變 positions[0] ~ positions[n-1] 的位置
+ * @details
+ * - positions：粒子的位置，直接修改
+ * - TTLs：每個粒子的TTL（已經減一）
+ * - n：粒子數
+ *
+ * 可能同時在多個執行緒上對不重疊的範圍呼叫，所以不能修改自己的狀態。
+ */
+typedef std::function<void(glm::vec3* positions, const unsigned* TTLs, size_t n)> Batch;
+
+/// 粒子數超過這個數時，apply() 會分給多個執行緒
+constexpr size_t Parallel_Particles = 1 << 15;
+
+/// 每次update移動 velocity
+Batch linear_drift(const glm::vec3& velocity);
+
+/// 浮力：TTL每多1，每次update多移動 rise_per_TTL（越新的粒子飄得越快）
+Batch buoyancy(const glm::vec3& rise_per_TTL);
+
+/**
+ * @brief 風：越高風越大
+ * @details 每次update移動 velocity * max(y, 0) / reference_height
+ * @param velocity - 高度為 reference_height 時每次update移動多少
+ * @param reference_height - 參考高度，必須大於0
+ */
+Batch wind(const glm::vec3& velocity, float reference_height);
+
+/// 依序套用 first、second
+Batch combine(Batch first, Batch second);
+
+/// 把每個粒子各自的轉換函式（新位置 = transform(舊位置, TTL)）包成 Batch
+Batch per_particle(std::function<glm::vec3(const glm::vec3&, unsigned)> transform);
+
+/**
+ * @brief 用 transform 改變 positions[0] ~ positions[n-1] 的位置
+ * @details n 不小於 Parallel_Particles 時切成連續的幾段，分給多個執行緒；每段的範圍不會重疊
+ */
+void apply(const Batch& transform, glm::vec3* positions, const unsigned* TTLs, size_t n);
+
+}
+
+#endif // PARTICLETRANSFORM_H
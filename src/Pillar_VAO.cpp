@@ -0,0 +1,51 @@
+#include "Pillar_VAO.h"
+#include "RayCast.h"
+
+Pillar_VAO::Pillar_VAO()
+    : Box_VAO(1.f), m_instance_vbo(0), m_pillar_num(0), m_positions()
+{
+    glBindVertexArray(m_VAO_id);
+
+    glGenBuffers(1, &m_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    // 3 -> aCpPos
+    glVertexAttribPointer(3, 3, GL_FLOAT, false, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1); // 每過一個instance才取一個位置
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Pillar_VAO::~Pillar_VAO()
+{
+    glDeleteBuffers(1, &m_instance_vbo);
+}
+
+void Pillar_VAO::set_positions(const std::vector<glm::vec3> &positions)
+{
+    m_pillar_num = static_cast<GLsizei>(positions.size());
+    m_positions = positions;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Pillar_VAO::append_triangles(std::vector<glm::vec3> &triangles, float cp_size) const
+{
+    // 水平方向為 ±cp_size，從 pos.y - cp_size 一直延伸到 y = -1
+    for (const glm::vec3& pos : m_positions) {
+        const float top = pos.y - cp_size;
+        if (top <= -1)
+            continue;
+        const float half_height = 0.5f * (top + 1);
+        RayCast::append_box(triangles, glm::vec3(pos.x, top - half_height, pos.z),
+                            glm::vec3(cp_size, 0, 0), glm::vec3(0, half_height, 0), glm::vec3(0, 0, cp_size));
+    }
+}
+
+void Pillar_VAO::draw()
+{
+    this->drawInstanced(m_pillar_num);
+}
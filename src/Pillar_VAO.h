@@ -0,0 +1,52 @@
+/**
+ * @file Pillar_VAO.h
+ * @brief 木頭支柱
+ */
+#ifndef PILLAR_VAO_H
+#define PILLAR_VAO_H
+
+#include <Box_VAO.h>
+#include <vector>
+#include <glm/vec3.hpp>
+
+/**
+ * @brief 所有的木頭支柱
+ * @details
+ * 所有支柱共用一個方塊的mesh，每個支柱頂端的位置放在instance buffer中，
+ * 呼叫 draw() 時用instanced draw一次畫出所有支柱。支柱的高度由shader決定（一直延伸到y=-1）。
+ *
+ * 提供的Attribute:
+ * - (location = 0) aPos，(-1, -1, -1) ~ (1, 1, 1)
+ * - (location = 2) aNormal
+ * - (location = 3) aCpPos，每個支柱頂端的位置
+ */
+class Pillar_VAO : public Box_VAO
+{
+    GLuint m_instance_vbo; ///< 每個支柱頂端的位置
+    GLsizei m_pillar_num;  ///< 支柱的數量
+
+    std::vector<glm::vec3> m_positions; ///< instance buffer的內容，給CPU的ray cast用
+
+public:
+    Pillar_VAO();
+
+    /// 呼叫 glDeleteBuffers
+    ~Pillar_VAO();
+
+    /// 更新instance buffer（只在支柱的位置改變時需要呼叫）
+    void set_positions(const std::vector<glm::vec3>& positions);
+
+    /// 支柱的數量
+    GLsizei pillar_num() const { return m_pillar_num; }
+
+    /**
+     * @brief 將所有支柱的三角形（世界座標，每3個點為一個三角形）加到 triangles 後面
+     * @param cp_size - 同 wood.vert 的 cp_size，形狀也和 wood.vert 算的相同
+     */
+    void append_triangles(std::vector<glm::vec3>& triangles, float cp_size) const;
+
+    /// 一次畫出所有支柱
+    void draw() override;
+};
+
+#endif // PILLAR_VAO_H
@@ -4,14 +4,13 @@
 PostProcessor::PostProcessor(GLint width, GLint height)
     : m_type(Type::NoProcess), m_FBO(width, height), m_old_FBO(0),
     m_shader("shader/post_process.vert", nullptr, nullptr, nullptr, "shader/post_process.frag"),
+    m_uniform_size(m_shader.uniform<glm::ivec2>("size")), m_uniform_type(m_shader.uniform<GLint>("type")),
     m_whole_screen_VAO(), m_which_speed(0)
 {
-    m_shader.Use();
-    glUniform1i(glGetUniformLocation(m_shader.Program, "color_buffer"), 0);
-    glUniform1i(glGetUniformLocation(m_shader.Program, "depth_buffer"), 1);
-    glUniform1i(glGetUniformLocation(m_shader.Program, "noise_texture"), 2);
-    glUniform2i(glGetUniformLocation(m_shader.Program, "size"), width, height);
-    glUseProgram(0);
+    m_shader.uniform<GLint>("color_buffer").set(0);
+    m_shader.uniform<GLint>("depth_buffer").set(1);
+    m_shader.uniform<GLint>("noise_texture").set(2);
+    m_uniform_size.set(glm::ivec2(width, height));
 
     QString file_pattern(":/speed/frame%1.png");
     for (int i = 1; i <= SPEED_NUM; ++i) {
@@ -23,18 +22,14 @@ void PostProcessor::resize(GLint width, GLint height)
 {
     m_FBO.resize(width, height);
 
-    m_shader.Use();
-    glUniform2i(glGetUniformLocation(m_shader.Program, "size"), width, height);
-    glUseProgram(0);
+    m_uniform_size.set(glm::ivec2(width, height));
 }
 
 void PostProcessor::changeType(Type type)
 {
     m_type = type;
 
-    m_shader.Use();
-    glUniform1i(glGetUniformLocation(m_shader.Program, "type"), (int)type);
-    glUseProgram(0);
+    m_uniform_type.set(static_cast<GLint>(type));
 }
 
 void PostProcessor::prepare()
@@ -34,6 +34,8 @@ private:
     FBO m_FBO; ///< 自己的FBO
     GLint m_old_FBO; ///< 呼叫 prepare() 時，將原本的 GL_DRAW_FRAMEBUFFER_BINDING 給記起來
     Shader m_shader;  ///< shader，用來做後處理
+    Shader::Uniform<glm::ivec2> m_uniform_size; ///< uniform size
+    Shader::Uniform<GLint> m_uniform_type;      ///< uniform type
     Plane_VAO m_whole_screen_VAO; ///< 繪製整個螢幕
 
     std::vector<qtTextureImage2D> m_speeds; ///< textures of speed line
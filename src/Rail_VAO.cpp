@@ -0,0 +1,123 @@
+#include "Rail_VAO.h"
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+
+/// 截面有4個邊，每邊2個頂點（各邊的法向量不同，所以頂點不共用）
+constexpr size_t VERTICES_PER_RAIL = 8;
+/// 每個取樣點有兩條鐵軌的截面
+constexpr size_t VERTICES_PER_RING = 2 * VERTICES_PER_RAIL;
+
+Rail_VAO::Rail_VAO(float gauge, float width, float height, size_t samples)
+    : m_vbo(0), m_ebo(0), m_index_count(0), m_gauge(gauge), m_width(width), m_height(height), m_samples(samples)
+{
+    glBindVertexArray(m_VAO_id);
+
+    glGenBuffers(1, &m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    // 0 -> aPos
+    glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(GLfloat), (void*)0);
+    glEnableVertexAttribArray(0);
+    // 2 -> aNormal
+    glVertexAttribPointer(2, 3, GL_FLOAT, false, 6 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+
+    glGenBuffers(1, &m_ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+Rail_VAO::~Rail_VAO()
+{
+    glDeleteBuffers(1, &m_vbo);
+    glDeleteBuffers(1, &m_ebo);
+}
+
+void Rail_VAO::build_mesh(const TrackCurve& track, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) const
+{
+    // 每段曲線取 t = 0, 1/samples, ..., (samples-1)/samples，最後一個點會接回整條軌道的起點
+    std::vector<float> t(m_samples);
+    for (size_t k = 0; k < m_samples; ++k)
+        t[k] = static_cast<float>(k) / m_samples;
+
+    Draw::Points_SoA points, orients;
+    Draw::evaluate_segments(track.pos_segments().data(), track.segment_num(), t.data(), m_samples, points);
+    Draw::evaluate_segments(track.orient_segments().data(), track.segment_num(), t.data(), m_samples, orients);
+    const size_t ring_num = points.size();
+
+    // 截面的四個角，以 (RIGHT, UP) 為座標
+    const float hw = 0.5f * m_width, hh = 0.5f * m_height;
+    const glm::vec2 corners[4] = { {-hw, hh}, {hw, hh}, {hw, -hh}, {-hw, -hh} };
+
+    vertices.clear();
+    vertices.reserve(ring_num * VERTICES_PER_RING * 6);
+    glm::vec3 RIGHT(1, 0, 0), UP(0, 1, 0);
+    for (size_t k = 0; k < ring_num; ++k) {
+        // 用前後兩點求方向向量
+        const glm::vec3 U = points[(k + 1) % ring_num] - points[(k + ring_num - 1) % ring_num];
+        const glm::vec3 right = glm::cross(U, orients[k]);
+        if (glm::length(right) > 1.e-6f) { // 方向向量或orient退化時，沿用前一個截面的方向
+            RIGHT = glm::normalize(right);
+            UP = glm::normalize(glm::cross(RIGHT, U));
+        }
+        const glm::vec3 normals[4] = { UP, RIGHT, -UP, -RIGHT }; // 上、右、下、左
+
+        for (float side : { -1.f, 1.f }) {
+            const glm::vec3 center = points[k] + side * m_gauge * RIGHT;
+            for (int e = 0; e < 4; ++e) {
+                for (int c : { e, (e + 1) % 4 }) {
+                    const glm::vec3 pos = center + corners[c].x * RIGHT + corners[c].y * UP;
+                    vertices.insert(vertices.end(), { pos.x, pos.y, pos.z, normals[e].x, normals[e].y, normals[e].z });
+                }
+            }
+        }
+    }
+
+    // 相鄰兩個截面的同一邊連成一個四邊形（兩個三角形）
+    indices.clear();
+    indices.reserve(ring_num * VERTICES_PER_RING * 3);
+    for (size_t k = 0; k < ring_num; ++k) {
+        const GLuint ring = static_cast<GLuint>(k * VERTICES_PER_RING);
+        const GLuint next_ring = static_cast<GLuint>(((k + 1) % ring_num) * VERTICES_PER_RING);
+        for (GLuint v = 0; v < VERTICES_PER_RING; v += 2) {
+            indices.insert(indices.end(), { ring + v, ring + v + 1, next_ring + v + 1,
+                                            ring + v, next_ring + v + 1, next_ring + v });
+        }
+    }
+}
+
+void Rail_VAO::rebuild(const TrackCurve &track)
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    build_mesh(track, vertices, indices);
+    m_index_count = static_cast<GLsizei>(indices.size());
+
+    glBindVertexArray(m_VAO_id);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Rail_VAO::append_triangles(const TrackCurve& track, std::vector<glm::vec3>& triangles) const
+{
+    std::vector<GLfloat> vertices;
+    std::vector<GLuint> indices;
+    build_mesh(track, vertices, indices);
+
+    triangles.reserve(triangles.size() + indices.size());
+    for (GLuint i : indices)
+        triangles.emplace_back(vertices[6 * i], vertices[6 * i + 1], vertices[6 * i + 2]);
+}
+
+void Rail_VAO::draw()
+{
+    glBindVertexArray(m_VAO_id);
+    glDrawElements(GL_TRIANGLES, m_index_count, GL_UNSIGNED_INT, nullptr);
+    glBindVertexArray(0);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file Rail_VAO.h
+ * @brief 軌道（兩條鐵軌）的mesh
+ */
+#ifndef RAIL_VAO_H
+#define RAIL_VAO_H
+
+#include <VAO_Interface.h>
+#include <cstddef>
+#include <vector>
+#include <glm/vec3.hpp>
+#include "TrackCurve.h"
+
+/**
+ * @brief 軌道的兩條鐵軌
+ * @details
+ * 沿著軌道取樣，在每個取樣點放一個長方形的截面，再把相鄰的截面連起來成為mesh。
+ * mesh只在軌道改變時用 rebuild() 重建，畫的時候只需要一次 glDrawElements。
+ * 頂點已經在世界座標中，不需要model matrix。
+ *
+ * 提供的Attribute:
+ * - (location = 0) aPos
+ * - (location = 2) aNormal
+ */
+class Rail_VAO : public VAO_Interface
+{
+    GLuint m_vbo;
+    GLuint m_ebo;
+    GLsizei m_index_count; ///< EBO中有幾個index
+
+    float m_gauge;       ///< 鐵軌中心到軌道中心的距離
+    float m_width;       ///< 截面的寬
+    float m_height;      ///< 截面的高
+    size_t m_samples;    ///< 每段曲線取樣幾次
+
+public:
+    /**
+     * @param gauge - 鐵軌中心到軌道中心的距離
+     * @param width - 鐵軌截面的寬
+     * @param height - 鐵軌截面的高
+     * @param samples - 每段曲線取樣幾次
+     */
+    Rail_VAO(float gauge, float width, float height, size_t samples);
+
+    /// 呼叫 glDeleteBuffers
+    ~Rail_VAO();
+
+    /**
+     * @brief 依照軌道重建mesh
+     * @param track - 軌道，至少要有一段曲線
+     */
+    void rebuild(const TrackCurve& track);
+
+    /**
+     * @brief 將 track 的mesh的所有三角形（世界座標，每3個點為一個三角形）加到 triangles 後面
+     * @details 和 rebuild() 算出相同的mesh，但不保留也不上傳，給CPU的ray cast用
+     * @param track - 軌道，至少要有一段曲線
+     */
+    void append_triangles(const TrackCurve& track, std::vector<glm::vec3>& triangles) const;
+
+    /// 畫出兩條鐵軌
+    void draw() override;
+
+private:
+    /// 依照軌道算出mesh：vertices 每6個float為一個頂點（位置、法向量），indices 每3個為一個三角形
+    void build_mesh(const TrackCurve& track, std::vector<GLfloat>& vertices, std::vector<GLuint>& indices) const;
+};
+
+#endif // RAIL_VAO_H
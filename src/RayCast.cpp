@@ -0,0 +1,187 @@
+#include "RayCast.h"
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace RayCast {
+
+float plane_y(const Ray &ray, float height)
+{
+    if (ray.dir.y == 0)
+        return No_Hit;
+    const float t = (height - ray.origin.y) / ray.dir.y;
+    return t >= 0 ? t : No_Hit;
+}
+
+float box(const Ray &ray, const glm::vec3 &min, const glm::vec3 &max)
+{
+    float t_near = 0, t_far = No_Hit;
+    for (int k = 0; k < 3; ++k) {
+        if (ray.dir[k] == 0) {
+            // 和這組平面平行：起點須在兩個平面之間
+            if (ray.origin[k] < min[k] || ray.origin[k] > max[k])
+                return No_Hit;
+            continue;
+        }
+        const float inv = 1.f / ray.dir[k];
+        float t0 = (min[k] - ray.origin[k]) * inv;
+        float t1 = (max[k] - ray.origin[k]) * inv;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        t_near = std::max(t_near, t0);
+        t_far = std::min(t_far, t1);
+        if (t_near > t_far)
+            return No_Hit;
+    }
+    return t_near;
+}
+
+float triangle(const Ray &ray, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c)
+{
+    constexpr float Epsilon = 1e-8f;
+    const glm::vec3 e1 = b - a, e2 = c - a;
+    const glm::vec3 p = glm::cross(ray.dir, e2);
+    const float det = glm::dot(e1, p);
+    if (std::abs(det) < Epsilon)
+        return No_Hit;
+
+    const float inv_det = 1.f / det;
+    const glm::vec3 s = ray.origin - a;
+    const float u = glm::dot(s, p) * inv_det;
+    if (u < 0 || u > 1)
+        return No_Hit;
+
+    const glm::vec3 q = glm::cross(s, e1);
+    const float v = glm::dot(ray.dir, q) * inv_det;
+    if (v < 0 || u + v > 1)
+        return No_Hit;
+
+    const float t = glm::dot(e2, q) * inv_det;
+    return t >= 0 ? t : No_Hit;
+}
+
+void append_box(std::vector<glm::vec3> &triangles, const glm::vec3 &center,
+                const glm::vec3 &X, const glm::vec3 &Y, const glm::vec3 &Z)
+{
+    // 第i個角：i的第0、1、2個bit分別決定 ±X、±Y、±Z
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+        corners[i] = center + (i & 1 ? X : -X) + (i & 2 ? Y : -Y) + (i & 4 ? Z : -Z);
+
+    // 每個面為某個bit固定的4個角，另外兩個bit依序走一圈
+    for (int axis = 0; axis < 3; ++axis) {
+        const int u = 1 << ((axis + 1) % 3), v = 1 << ((axis + 2) % 3);
+        for (int side : { 0, 1 << axis }) {
+            const glm::vec3& a = corners[side];
+            const glm::vec3& b = corners[side | u];
+            const glm::vec3& c = corners[side | u | v];
+            const glm::vec3& d = corners[side | v];
+            triangles.insert(triangles.end(), { a, b, c, a, c, d });
+        }
+    }
+}
+
+}
+
+TriangleBVH::TriangleBVH(std::vector<glm::vec3> triangles)
+{
+    triangles.resize(triangles.size() / 3 * 3);
+    const uint32_t num = static_cast<uint32_t>(triangles.size() / 3);
+    if (num == 0)
+        return;
+
+    std::vector<glm::vec3> centers(num);
+    std::vector<uint32_t> order(num);
+    for (uint32_t i = 0; i < num; ++i) {
+        centers[i] = (triangles[3 * i] + triangles[3 * i + 1] + triangles[3 * i + 2]) / 3.f;
+        order[i] = i;
+    }
+
+    m_nodes.reserve(2 * (num / Leaf_Size + 1));
+    this->build(order, centers, triangles, 0, num);
+
+    // 依照leaf的順序重排三角形，traversal時每個leaf讀的是連續的記憶體
+    m_triangles.resize(triangles.size());
+    for (uint32_t i = 0; i < num; ++i) {
+        for (int k = 0; k < 3; ++k)
+            m_triangles[3 * i + k] = triangles[3 * order[i] + k];
+    }
+}
+
+uint32_t TriangleBVH::build(std::vector<uint32_t> &order, const std::vector<glm::vec3> &centers,
+                            const std::vector<glm::vec3> &triangles, uint32_t first, uint32_t count)
+{
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    glm::vec3 min(RayCast::No_Hit), max(-RayCast::No_Hit);
+    glm::vec3 center_min(RayCast::No_Hit), center_max(-RayCast::No_Hit);
+    for (uint32_t i = first; i < first + count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            min = glm::min(min, triangles[3 * order[i] + k]);
+            max = glm::max(max, triangles[3 * order[i] + k]);
+        }
+        center_min = glm::min(center_min, centers[order[i]]);
+        center_max = glm::max(center_max, centers[order[i]]);
+    }
+    // 稍微放大bounding box：射線剛好打在三角形的邊或頂點上時，slab test的捨入誤差可能會錯過它
+    const glm::vec3 pad(1.e-5f * (glm::length(max - min) + glm::length(max + min)));
+    m_nodes[index].min = min - pad;
+    m_nodes[index].max = max + pad;
+
+    if (count <= Leaf_Size) {
+        m_nodes[index].first = first;
+        m_nodes[index].count = count;
+        return index;
+    }
+
+    // 沿著中心分布最廣的軸，從中位數切開
+    const glm::vec3 extent = center_max - center_min;
+    const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    const uint32_t half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                     [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+
+    this->build(order, centers, triangles, first, half); // 左子node就是 index + 1
+    const uint32_t right = this->build(order, centers, triangles, first + half, count - half);
+    m_nodes[index].first = right;
+    m_nodes[index].count = 0;
+    return index;
+}
+
+float TriangleBVH::intersect(const Ray &ray) const
+{
+    float best = RayCast::No_Hit;
+    if (m_nodes.empty() || RayCast::box(ray, m_nodes[0].min, m_nodes[0].max) == RayCast::No_Hit)
+        return best;
+
+    // 樹的深度約為 log2(n / Leaf_Size)，64層足夠
+    uint32_t stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = m_nodes[stack[--top]];
+
+        if (node.count > 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                best = std::min(best, RayCast::triangle(ray, m_triangles[3 * i], m_triangles[3 * i + 1], m_triangles[3 * i + 2]));
+            continue;
+        }
+
+        uint32_t near_child = static_cast<uint32_t>(&node - m_nodes.data()) + 1, far_child = node.first;
+        float t_near = RayCast::box(ray, m_nodes[near_child].min, m_nodes[near_child].max);
+        float t_far = RayCast::box(ray, m_nodes[far_child].min, m_nodes[far_child].max);
+        if (t_far < t_near) {
+            std::swap(near_child, far_child);
+            std::swap(t_near, t_far);
+        }
+        // 先放遠的，先走近的；比目前最近的交點還遠的子node不用走
+        if (t_far < best)
+            stack[top++] = far_child;
+        if (t_near < best)
+            stack[top++] = near_child;
+    }
+    return best;
+}
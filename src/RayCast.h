@@ -0,0 +1,96 @@
+/**
+ * @file RayCast.h
+ * @brief 在CPU上做射線和場景的相交測試
+ */
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// 射線 origin + t * dir（t >= 0）
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 dir;    ///< 不需要是單位向量，t 以 dir 的長度為單位
+};
+
+namespace RayCast {
+
+/// 沒有打到時的 t
+constexpr float No_Hit = std::numeric_limits<float>::infinity();
+
+/**
+ * @brief 射線和水平面 y = height 的交點
+ * @return 交點的 t；和平面平行或交點在射線後方時回傳 No_Hit
+ */
+float plane_y(const Ray& ray, float height);
+
+/**
+ * @brief 射線和軸對齊的box [min, max] 的交點（slab test）
+ * @return 射進box時的 t（起點在box內時為0）；沒有打到時回傳 No_Hit
+ */
+float box(const Ray& ray, const glm::vec3& min, const glm::vec3& max);
+
+/**
+ * @brief 射線和三角形的交點（Möller–Trumbore），兩面都算
+ * @return 交點的 t；沒有打到時回傳 No_Hit
+ */
+float triangle(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+
+/**
+ * @brief 將平行六面體 center ± X ± Y ± Z 的12個三角形加到 triangles 後面
+ * @details 給用方塊畫的物件（枕木、支柱等）建 TriangleBVH 用
+ */
+void append_box(std::vector<glm::vec3>& triangles, const glm::vec3& center,
+                const glm::vec3& X, const glm::vec3& Y, const glm::vec3& Z);
+
+}
+
+/**
+ * @brief 三角形的 Bounding Volume Hierarchy
+ * @details
+ * 建構時每次沿著三角形中心分布最廣的軸，從中位數切成兩半，直到一個node只剩 Leaf_Size 個三角形。
+ * node 存在一個陣列中：左子node緊接在父node後面，只記錄右子node的位置，traversal時先走離射線起點較近的子node。
+ *
+ * 建好後只讀不寫，可以在任何thread使用。這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class TriangleBVH
+{
+public:
+    /// 一個leaf最多幾個三角形
+    static constexpr uint32_t Leaf_Size = 4;
+
+private:
+    struct Node {
+        glm::vec3 min, max; ///< bounding box
+        uint32_t first;     ///< leaf: 第一個三角形；內部node: 右子node的index
+        uint32_t count;     ///< leaf: 三角形的個數；內部node為0
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<glm::vec3> m_triangles; ///< 每3個為一個三角形，依照leaf的順序排列
+
+public:
+    TriangleBVH() = default;
+
+    /**
+     * @brief 建構
+     * @param triangles - 每3個點為一個三角形（世界座標）
+     */
+    explicit TriangleBVH(std::vector<glm::vec3> triangles);
+
+    /// 三角形的個數
+    size_t triangle_num() const { return m_triangles.size() / 3; }
+
+    /// 最近的交點的 t；沒有打到時回傳 RayCast::No_Hit
+    float intersect(const Ray& ray) const;
+
+private:
+    /// 建構 [first, first + count) 的三角形的子樹，回傳它的node index
+    uint32_t build(std::vector<uint32_t>& order, const std::vector<glm::vec3>& centers,
+                   const std::vector<glm::vec3>& triangles, uint32_t first, uint32_t count);
+};
+
+#endif // RAYCAST_H
@@ -6,8 +6,7 @@ Skybox::Skybox()
     m_cubemap(":/right.jpg", ":/left.jpg", ":/top.jpg", ":/bottom.jpg", ":/front.jpg", ":/back.jpg"),
     m_skybox_shader("shader/skybox.vert", nullptr, nullptr, nullptr, "shader/skybox.frag")
 {
-    m_skybox_shader.Use();
-    glUniform1i(glGetUniformLocation(m_skybox_shader.Program, "skybox"), 0);
+    m_skybox_shader.uniform<GLint>("skybox").set(0);
 }
 
 void Skybox::draw(bool wireframe)
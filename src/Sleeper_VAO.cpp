@@ -0,0 +1,66 @@
+#include "Sleeper_VAO.h"
+#include <cmath>
+#include <algorithm>
+#include "RayCast.h"
+
+Sleeper_VAO::Sleeper_VAO(float size, float interval)
+    : Box_VAO(1.f), m_instance_vbo(0), m_sleeper_num(0), m_size(size), m_interval(interval), m_models()
+{
+    glBindVertexArray(m_VAO_id);
+
+    glGenBuffers(1, &m_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    // mat4 佔用 3 ~ 6 四個位置，每個位置放一個column
+    for (GLuint i = 0; i < 4; ++i) {
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, false, sizeof(glm::mat4), (void*)(i * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + i);
+        glVertexAttribDivisor(3 + i, 1); // 每過一個instance才取一個model matrix
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+Sleeper_VAO::~Sleeper_VAO()
+{
+    glDeleteBuffers(1, &m_instance_vbo);
+}
+
+void Sleeper_VAO::rebuild(const FrameTable &frames)
+{
+    // 把軌道分成整數段，每段的中間放一個枕木
+    const size_t N = std::max<size_t>(1, static_cast<size_t>(std::round(frames.length() / m_interval)));
+    const float step = frames.length() / N;
+
+    m_models.clear();
+    m_models.reserve(N);
+    for (size_t k = 0; k < N; ++k) {
+        const FrameTable::Frame f = frames.at((k + 0.5f) * step);
+        const glm::vec3 DOWN = -f.TOP;
+        const glm::vec3 middle = f.pos + DOWN * m_size * 0.05f; // 往下一點點
+
+        // model = translate(middle) * rotate(LEFT, DOWN, FRONT) * scale * translate(0, 1, 0)
+        // 方塊往DOWN的方向平移，讓它的上表面剛好在軌道上
+        const glm::vec3 X = f.LEFT * (m_size * 1.3f);
+        const glm::vec3 Y = DOWN * (m_size * 0.1f);
+        const glm::vec3 Z = f.FRONT * (step * 0.3f);
+        m_models.emplace_back(glm::vec4(X, 0), glm::vec4(Y, 0), glm::vec4(Z, 0), glm::vec4(middle + Y, 1));
+    }
+    m_sleeper_num = static_cast<GLsizei>(m_models.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, m_models.size() * sizeof(glm::mat4), m_models.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Sleeper_VAO::append_triangles(std::vector<glm::vec3> &triangles) const
+{
+    // 方塊的範圍是 (-1, -1, -1) ~ (1, 1, 1)，model matrix的前三個column就是三個半軸
+    for (const glm::mat4& model : m_models)
+        RayCast::append_box(triangles, glm::vec3(model[3]), glm::vec3(model[0]), glm::vec3(model[1]), glm::vec3(model[2]));
+}
+
+void Sleeper_VAO::draw()
+{
+    this->drawInstanced(m_sleeper_num);
+}
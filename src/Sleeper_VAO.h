@@ -0,0 +1,61 @@
+/**
+ * @file Sleeper_VAO.h
+ * @brief 沿著軌道的所有枕木
+ */
+#ifndef SLEEPER_VAO_H
+#define SLEEPER_VAO_H
+
+#include <Box_VAO.h>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include "FrameTable.h"
+
+/**
+ * @brief 沿著軌道的所有枕木
+ * @details
+ * 所有枕木共用一個方塊的mesh，每個枕木的model matrix放在instance buffer中。
+ * 軌道改變時用 rebuild() 從座標系表重算所有model matrix，畫的時候只需要一次 glDrawArraysInstanced，
+ * 不會因為軌道變長而增加draw call。
+ *
+ * 提供的Attribute:
+ * - (location = 0) aPos，(-1, -1, -1) ~ (1, 1, 1)
+ * - (location = 2) aNormal
+ * - (location = 3 ~ 6) aModel，每個instance的model matrix
+ */
+class Sleeper_VAO : public Box_VAO
+{
+    GLuint m_instance_vbo; ///< 每個枕木的model matrix
+    GLsizei m_sleeper_num; ///< 枕木的數量
+
+    float m_size;          ///< 枕木的大小（寬約 2.6 * size）
+    float m_interval;      ///< 相鄰兩個枕木的距離
+
+    std::vector<glm::mat4> m_models; ///< instance buffer的內容，給CPU的ray cast用
+
+public:
+    /**
+     * @param size - 枕木的大小
+     * @param interval - 相鄰兩個枕木的距離（實際距離），會稍微調整讓整條軌道剛好放整數個
+     */
+    Sleeper_VAO(float size, float interval);
+
+    /// 呼叫 glDeleteBuffers
+    ~Sleeper_VAO();
+
+    /**
+     * @brief 依照軌道的座標系表重算每個枕木的model matrix
+     * @param frames - 座標系表，不可為空
+     */
+    void rebuild(const FrameTable& frames);
+
+    /// 枕木的數量
+    GLsizei sleeper_num() const { return m_sleeper_num; }
+
+    /// 將所有枕木的三角形（世界座標，每3個點為一個三角形）加到 triangles 後面
+    void append_triangles(std::vector<glm::vec3>& triangles) const;
+
+    /// 一次畫出所有枕木
+    void draw() override;
+};
+
+#endif // SLEEPER_VAO_H
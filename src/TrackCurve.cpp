@@ -0,0 +1,176 @@
+/**
+ * @file TrackCurve.cpp
+ * @brief 實作TrackCurve.h
+ */
+#include "TrackCurve.h"
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+/// 由第i個控制點開始的那段曲線
+static Draw::Cubic_Segment make_pos_segment(const std::vector<ControlPoint>& cps, size_t i, SplineType type, float tension)
+{
+    const size_t N = cps.size();
+    return Draw::make_segment(type, cps[(i + N - 1) % N].pos, cps[i].pos, cps[(i + 1) % N].pos, cps[(i + 2) % N].pos, tension);
+}
+
+/// 由第i個控制點開始的那段orient
+static Draw::Cubic_Segment make_orient_segment(const std::vector<ControlPoint>& cps, size_t i, SplineType type, float tension)
+{
+    const size_t N = cps.size();
+    return Draw::make_segment(type, cps[(i + N - 1) % N].orient, cps[i].orient, cps[(i + 1) % N].orient, cps[(i + 2) % N].orient, tension);
+}
+
+/// 將 cp_id 相同的連續幾項分成一組，每組呼叫一次 Draw::evaluate_batch()
+static void batch_by_segment(const std::vector<Draw::Cubic_Segment>& segments, const size_t* cp_id, const float* t, size_t n,
+                             Draw::Points_SoA& out)
+{
+    out.resize(n);
+    for (size_t begin = 0, end; begin < n; begin = end) {
+        for (end = begin + 1; end < n && cp_id[end] == cp_id[begin]; ++end) {}
+        Draw::evaluate_batch(segments[cp_id[begin]], t + begin, end - begin,
+                             out.x.data() + begin, out.y.data() + begin, out.z.data() + begin);
+    }
+}
+
+TrackCurve::TrackCurve()
+    : m_pos_segments(), m_orient_segments(), m_arc_len_accum(), m_revision(0)
+{
+}
+
+void TrackCurve::rebuild(const std::vector<ControlPoint> &control_points, SplineType type, float tension, float tolerance)
+{
+    const size_t N = control_points.size();
+
+    // 參數式
+    m_pos_segments.resize(N);
+    m_orient_segments.resize(N);
+    for (size_t i = 0; i < N; ++i) {
+        m_pos_segments[i] = make_pos_segment(control_points, i, type, tension);
+        m_orient_segments[i] = make_orient_segment(control_points, i, type, tension);
+    }
+
+    // 曲線長累積表
+    m_arc_len_accum.clear();
+    for (size_t i = 0; i < N; ++i) {
+        // 對速率 |dP/dt| 做適應性積分
+        m_arc_len_accum.append_segment(m_pos_segments[i], tolerance);
+    }
+    m_arc_len_accum.finalize();
+    ++m_revision;
+}
+
+// 第i段曲線由第 i-1、i、i+1、i+2 個控制點決定，
+// 所以第j個控制點會影響第 j-2、j-1、j、j+1 段
+
+void TrackCurve::rebuild(const std::vector<ControlPoint> &control_points, SplineType type, float tension,
+                         std::vector<ArcLenAccum::Table_T> tables)
+{
+    assert(tables.size() == control_points.size());
+    const size_t N = control_points.size();
+
+    // 參數式
+    m_pos_segments.resize(N);
+    m_orient_segments.resize(N);
+    for (size_t i = 0; i < N; ++i) {
+        m_pos_segments[i] = make_pos_segment(control_points, i, type, tension);
+        m_orient_segments[i] = make_orient_segment(control_points, i, type, tension);
+    }
+
+    // 曲線長累積表
+    m_arc_len_accum.clear();
+    for (auto& table : tables)
+        m_arc_len_accum.append_table(std::move(table));
+    m_arc_len_accum.finalize();
+    ++m_revision;
+}
+
+void TrackCurve::update_control_point(const std::vector<ControlPoint> &control_points, size_t cp_id,
+                                      SplineType type, float tension, float tolerance)
+{
+    const size_t N = control_points.size();
+    assert(N == segment_num() && cp_id < N);
+
+    this->update_segments(control_points, (cp_id + N - 2) % N, 4, type, tension, tolerance);
+    m_arc_len_accum.finalize();
+    ++m_revision;
+}
+
+void TrackCurve::insert_control_point(const std::vector<ControlPoint> &control_points, size_t cp_id,
+                                      SplineType type, float tension, float tolerance)
+{
+    const size_t N = control_points.size();
+    assert(N == segment_num() + 1 && cp_id < N);
+
+    // 新的第cp_id段，原本的段往後移
+    m_pos_segments.insert(m_pos_segments.begin() + cp_id, make_pos_segment(control_points, cp_id, type, tension));
+    m_orient_segments.insert(m_orient_segments.begin() + cp_id, make_orient_segment(control_points, cp_id, type, tension));
+    m_arc_len_accum.insert_segment(cp_id, m_pos_segments[cp_id], tolerance);
+
+    // 第 j-2、j-1、j+1 段
+    this->update_segments(control_points, (cp_id + N - 2) % N, 2, type, tension, tolerance);
+    this->update_segments(control_points, (cp_id + 1) % N, 1, type, tension, tolerance);
+    m_arc_len_accum.finalize();
+    ++m_revision;
+}
+
+void TrackCurve::erase_control_point(const std::vector<ControlPoint> &control_points, size_t cp_id,
+                                     SplineType type, float tension, float tolerance)
+{
+    const size_t N = control_points.size();
+    assert(N + 1 == segment_num() && N > 0);
+
+    m_pos_segments.erase(m_pos_segments.begin() + cp_id);
+    m_orient_segments.erase(m_orient_segments.begin() + cp_id);
+    m_arc_len_accum.erase_segment(cp_id);
+
+    // 原本的第 j-2、j-1、j+1 段（現在的 j-2、j-1、j 段）
+    this->update_segments(control_points, (cp_id + N - 2) % N, 3, type, tension, tolerance);
+    m_arc_len_accum.finalize();
+    ++m_revision;
+}
+
+void TrackCurve::update_segments(const std::vector<ControlPoint> &control_points, size_t first, size_t count,
+                                 SplineType type, float tension, float tolerance)
+{
+    const size_t N = control_points.size();
+    count = std::min(count, N);
+
+    for (size_t k = 0; k < count; ++k) {
+        const size_t i = (first + k) % N;
+        m_pos_segments[i] = make_pos_segment(control_points, i, type, tension);
+        m_orient_segments[i] = make_orient_segment(control_points, i, type, tension);
+        m_arc_len_accum.set_segment(i, m_pos_segments[i], tolerance);
+    }
+}
+
+size_t TrackCurve::locate(float T, float &t) const
+{
+    const size_t cp_id = std::min(static_cast<size_t>(std::floor(T)), m_pos_segments.size() - 1);
+    t = T - cp_id;
+    return cp_id;
+}
+
+glm::vec3 TrackCurve::point_at(float T) const
+{
+    float t;
+    const size_t cp_id = this->locate(T, t);
+    return m_pos_segments[cp_id](t);
+}
+
+glm::vec3 TrackCurve::orient_at(float T) const
+{
+    float t;
+    const size_t cp_id = this->locate(T, t);
+    return m_orient_segments[cp_id](t);
+}
+
+void TrackCurve::batch_points(const size_t *cp_id, const float *t, size_t n, Draw::Points_SoA &out) const
+{
+    batch_by_segment(m_pos_segments, cp_id, t, n, out);
+}
+
+void TrackCurve::batch_orients(const size_t *cp_id, const float *t, size_t n, Draw::Points_SoA &out) const
+{
+    batch_by_segment(m_orient_segments, cp_id, t, n, out);
+}
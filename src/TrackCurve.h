@@ -0,0 +1,149 @@
+/**
+ * @file TrackCurve.h
+ * @brief 軌道曲線：每段曲線的參數式和曲線長累積表
+ */
+#ifndef TRACKCURVE_H
+#define TRACKCURVE_H
+
+#include <glm/vec3.hpp>
+#include <vector>
+#include "ParamEquation.h"
+#include "ArcLenAccum.h"
+
+/// 控制點
+struct ControlPoint {
+    glm::vec3 pos;
+    glm::vec3 orient;
+};
+
+/**
+ * @brief 軌道曲線
+ * @details
+ * 將「每兩個」控制點間的座標及orient參數式存起來，並建立整條軌道的曲線長累積表。
+ * 只有在spline的設定改變時才需要呼叫 rebuild()，其他時候所有畫軌道、枕木、火車的程式都只是查表。
+ *
+ * 每段曲線只由前後共四個控制點決定，所以只改動一個控制點時，
+ * 用 update_control_point()、insert_control_point()、erase_control_point() 只重算受影響的（最多四段）曲線，
+ * 其他段的參數式和區域表都不用重算，只需要再做一次前綴和。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class TrackCurve
+{
+private:
+    std::vector<Draw::Cubic_Segment> m_pos_segments;    ///< 第i項為 i 和 i+1 間座標的參數式
+    std::vector<Draw::Cubic_Segment> m_orient_segments; ///< 第i項為 i 和 i+1 間orient的參數式
+    ArcLenAccum m_arc_len_accum; ///< 整條軌道的曲線長累積表
+    size_t m_revision; ///< 每次曲線改變就加1
+
+public:
+    TrackCurve();
+
+    /**
+     * @brief 依照控制點重建所有參數式及曲線長累積表
+     * @param control_points - 控制點，至少要有一個
+     * @param type - spline的種類
+     * @param tension - cardinal spline的張力
+     * @param tolerance - 建立曲線長累積表時，每段曲線可接受的誤差
+     */
+    void rebuild(const std::vector<ControlPoint>& control_points, SplineType type, float tension, float tolerance);
+
+    /**
+     * @brief 同 rebuild()，但使用已經算好的區域表（如從檔案讀入的），不需要再積分
+     * @param tables - 第i項為第i段曲線的區域表，須和用同樣的 type、tension 建出來的一樣
+     * @pre tables.size() == control_points.size()
+     */
+    void rebuild(const std::vector<ControlPoint>& control_points, SplineType type, float tension,
+                 std::vector<ArcLenAccum::Table_T> tables);
+
+    /**
+     * @brief 第cp_id個控制點被修改後，只重算受影響的曲線
+     * @param control_points - 修改後的控制點
+     * @param cp_id - 被修改的控制點
+     * @param type, tension, tolerance - 同 rebuild()，須和上次重建時一樣
+     * @pre control_points.size() == segment_num()
+     */
+    void update_control_point(const std::vector<ControlPoint>& control_points, size_t cp_id,
+                              SplineType type, float tension, float tolerance);
+
+    /**
+     * @brief 在cp_id插入一個控制點後，只重算受影響的曲線
+     * @param control_points - 插入後的控制點（第cp_id個是新的控制點）
+     * @pre control_points.size() == segment_num() + 1
+     */
+    void insert_control_point(const std::vector<ControlPoint>& control_points, size_t cp_id,
+                              SplineType type, float tension, float tolerance);
+
+    /**
+     * @brief 刪除第cp_id個控制點後，只重算受影響的曲線
+     * @param control_points - 刪除後的控制點（原本的第cp_id+1個變成第cp_id個）
+     * @pre control_points.size() == segment_num() - 1
+     */
+    void erase_control_point(const std::vector<ControlPoint>& control_points, size_t cp_id,
+                             SplineType type, float tension, float tolerance);
+
+    /// @brief 每次曲線改變（rebuild()、update_control_point() 等）就會加1
+    /// @details 用來判斷由曲線產生的東西（如軌道的mesh）是否需要重建
+    size_t revision() const { return m_revision; }
+
+    /// 共有幾段曲線（等於控制點的個數）
+    size_t segment_num() const { return m_pos_segments.size(); }
+
+    /// 第i段曲線的座標參數式
+    const Draw::Cubic_Segment& pos_segment(size_t i) const { return m_pos_segments[i]; }
+
+    /// 第i段曲線的orient參數式
+    const Draw::Cubic_Segment& orient_segment(size_t i) const { return m_orient_segments[i]; }
+
+    /// 所有座標的參數式
+    const std::vector<Draw::Cubic_Segment>& pos_segments() const { return m_pos_segments; }
+
+    /// 所有orient的參數式
+    const std::vector<Draw::Cubic_Segment>& orient_segments() const { return m_orient_segments; }
+
+    /// 曲線長累積表
+    const ArcLenAccum& arc_len_accum() const { return m_arc_len_accum; }
+
+    /// 整條軌道的長度
+    float length() const { return m_arc_len_accum.max_S(); }
+
+    /// 將參數空間中的T 換成 實際距離S
+    float T_to_S(float T) const { return m_arc_len_accum.T_to_S(T); }
+
+    /// 將實際距離S 換成 參數空間中的T
+    float S_to_T(float S) const { return m_arc_len_accum.S_to_T(S); }
+
+    /**
+     * @brief 將參數空間中的T 拆成「第幾段」和「段內的t」
+     * @param T - 介於 [0, segment_num()) 間
+     * @param[out] t - 段內的t，介於 [0, 1) 間
+     * @return 第幾段
+     */
+    size_t locate(float T, float& t) const;
+
+    /// 參數空間中T的位置
+    glm::vec3 point_at(float T) const;
+
+    /// 參數空間中T的orient
+    glm::vec3 orient_at(float T) const;
+
+    /**
+     * @brief 批次求值，第k個點為第 cp_id[k] 段曲線在 t[k] 的座標
+     * @details cp_id 中連續相同的幾項會一起用 Draw::evaluate_batch() 求值，所以依序排好時最快
+     * @param[out] out - 會被resize成n項
+     */
+    void batch_points(const size_t* cp_id, const float* t, size_t n, Draw::Points_SoA& out) const;
+
+    /// 同 batch_points()，但求的是orient
+    void batch_orients(const size_t* cp_id, const float* t, size_t n, Draw::Points_SoA& out) const;
+
+private:
+    /**
+     * @brief 重算第 first 段開始（往後wrap）共 count 段曲線的參數式及區域表
+     * @note 之後要呼叫 ArcLenAccum::finalize()；count 超過段數時只會重算每段一次
+     */
+    void update_segments(const std::vector<ControlPoint>& control_points, size_t first, size_t count,
+                         SplineType type, float tension, float tolerance);
+};
+
+#endif // TRACKCURVE_H
@@ -0,0 +1,324 @@
+#include "TrackIO.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+static_assert(sizeof(ControlPoint) == 6 * sizeof(float), "ControlPoint must be 6 packed floats");
+
+namespace {
+
+/// 格式錯誤
+[[noreturn]] void fail(const char* what)
+{
+    throw std::runtime_error(std::string("ERROR::TRACK::").append(what));
+}
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief 用 std::from_chars 解析 [first, last) 這個數字
+ * @details 和原本用iostream讀的時候一樣，接受開頭的 '+'；不接受inf、nan
+ */
+template <class T>
+void parse_number(const char* first, const char* last, T& value)
+{
+    if (last - first > 1 && *first == '+' && first[1] != '-' && first[1] != '+')
+        ++first;
+
+    const std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last || !std::isfinite(value))
+        fail("TEXT::INVALID_NUMBER");
+}
+
+/// 每次從stream讀入一塊，並依序取出其中以空白分隔的字
+class Chunk_Reader
+{
+    std::istream& m_in;
+    std::vector<char> m_buf;
+    size_t m_pos; ///< 下一個還沒解析的字元
+    size_t m_end; ///< 緩衝區中有效資料的結尾
+    bool m_eof;
+
+public:
+    explicit Chunk_Reader(std::istream& in)
+        : m_in(in), m_buf(TrackIO::Text_Chunk_Size), m_pos(0), m_end(0), m_eof(false)
+    {}
+
+    /// 取出下一個字 [first, last)，到下一次呼叫前有效；沒有字時回傳false
+    bool next(const char*& first, const char*& last)
+    {
+        // 跳過空白
+        for (;;) {
+            while (m_pos < m_end && is_space(m_buf[m_pos]))
+                ++m_pos;
+            if (m_pos < m_end)
+                break;
+            if (!this->refill())
+                return false;
+        }
+
+        // 找到這個字的結尾；碰到緩衝區結尾時，把剩下的部分移到前面再讀一塊
+        size_t token_end = m_pos;
+        for (;;) {
+            while (token_end < m_end && !is_space(m_buf[token_end]))
+                ++token_end;
+            if (token_end < m_end || m_eof)
+                break;
+            const size_t offset = token_end - m_pos;
+            this->refill();
+            token_end = m_pos + offset;
+        }
+
+        first = m_buf.data() + m_pos;
+        last = m_buf.data() + token_end;
+        m_pos = token_end;
+        return true;
+    }
+
+private:
+    /// 把還沒解析的部分移到緩衝區開頭，再讀入一塊。已經讀完時回傳false
+    bool refill()
+    {
+        if (m_eof)
+            return false;
+
+        const size_t remain = m_end - m_pos;
+        std::memmove(m_buf.data(), m_buf.data() + m_pos, remain);
+        m_pos = 0;
+        m_end = remain;
+        if (m_end == m_buf.size()) // 一個數字比整個緩衝區還長
+            m_buf.resize(m_buf.size() * 2);
+
+        m_in.read(m_buf.data() + m_end, static_cast<std::streamsize>(m_buf.size() - m_end));
+        const size_t got = static_cast<size_t>(m_in.gcount());
+        m_end += got;
+        if (got == 0 || !m_in)
+            m_eof = true;
+        return got > 0;
+    }
+};
+
+/// 在已經整個在記憶體中的資料（如memory map的檔案）上依序取出以空白分隔的字，不需要複製
+class Buffer_Reader
+{
+    const char* m_pos;
+    const char* m_end;
+
+public:
+    Buffer_Reader(const void* data, size_t size)
+        : m_pos(static_cast<const char*>(data)), m_end(static_cast<const char*>(data) + size)
+    {}
+
+    /// 同 Chunk_Reader::next()
+    bool next(const char*& first, const char*& last)
+    {
+        while (m_pos < m_end && is_space(*m_pos))
+            ++m_pos;
+        if (m_pos == m_end)
+            return false;
+
+        first = m_pos;
+        while (m_pos < m_end && !is_space(*m_pos))
+            ++m_pos;
+        last = m_pos;
+        return true;
+    }
+};
+
+/// 用 Chunk_Reader 或 Buffer_Reader 解析文字格式
+template <class Reader>
+std::vector<ControlPoint> read_control_points(Reader& reader)
+{
+    const char* first;
+    const char* last;
+
+    // 個數也接受 "4.0" 這種寫法，但必須是非負整數
+    double num = 0;
+    if (!reader.next(first, last))
+        fail("TEXT::BAD_COUNT");
+    parse_number(first, last, num);
+    if (num < 0 || num != std::floor(num) || num > double(std::numeric_limits<uint32_t>::max()))
+        fail("TEXT::BAD_COUNT");
+
+    // 個數可能是亂寫的，不要一開始就配置那麼多；不夠時 push_back 會自己長大
+    std::vector<ControlPoint> control_points;
+    control_points.reserve(std::min(static_cast<size_t>(num), size_t(1) << 16));
+    for (size_t i = 0; i < static_cast<size_t>(num); ++i) {
+        ControlPoint cp;
+        float* v[6] = { &cp.pos.x, &cp.pos.y, &cp.pos.z, &cp.orient.x, &cp.orient.y, &cp.orient.z };
+        for (float* f : v) {
+            if (!reader.next(first, last))
+                fail("TEXT::TRUNCATED");
+            parse_number(first, last, *f);
+        }
+        control_points.push_back(cp);
+    }
+    return control_points;
+}
+
+/// 將 value 的最短表示法加到 out 後面
+void append_float(std::string& out, float value)
+{
+    char buf[32];
+    const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+}
+
+namespace TrackIO {
+
+bool is_binary(const void *data, size_t size)
+{
+    return size >= sizeof(Binary_Header) && std::memcmp(data, Binary_Magic, sizeof(Binary_Magic)) == 0;
+}
+
+Track_Data parse_binary(const void *data, size_t size)
+{
+    if (!is_binary(data, size))
+        fail("BINARY::BAD_MAGIC");
+
+    const char* bytes = static_cast<const char*>(data);
+    Binary_Header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.version == 0 || header.version > Binary_Version)
+        fail("BINARY::UNSUPPORTED_VERSION");
+
+    // 檢查大小時用64位元，避免惡意的個數造成溢位
+    const uint64_t cp_bytes = uint64_t(header.cp_num) * sizeof(ControlPoint);
+    uint64_t expected = sizeof(Binary_Header) + cp_bytes;
+    const bool has_table = (header.flags & Has_Arc_Len_Table) != 0;
+    if (has_table)
+        expected += uint64_t(header.cp_num) * sizeof(uint32_t) + uint64_t(header.table_entries) * 2 * sizeof(float);
+    if (size < expected)
+        fail("BINARY::TRUNCATED");
+
+    Track_Data track;
+    const char* p = bytes + sizeof(Binary_Header);
+    track.control_points.resize(header.cp_num);
+    std::memcpy(track.control_points.data(), p, cp_bytes);
+    p += cp_bytes;
+
+    if (has_table) {
+        track.has_arc_len_table = true;
+        track.type = static_cast<SplineType>(header.spline_type);
+        track.tension = header.tension;
+        track.tolerance = header.tolerance;
+
+        std::vector<uint32_t> samples(header.cp_num);
+        std::memcpy(samples.data(), p, samples.size() * sizeof(uint32_t));
+        p += samples.size() * sizeof(uint32_t);
+
+        uint64_t total = 0;
+        for (uint32_t n : samples)
+            total += n;
+        if (total != header.table_entries)
+            fail("BINARY::BAD_ARC_LEN_TABLE");
+
+        track.tables.resize(header.cp_num);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            ArcLenAccum::Table_T& table = track.tables[i];
+            table.resize(samples[i]);
+            for (auto& entry : table) {
+                float pair[2];
+                std::memcpy(pair, p, sizeof(pair));
+                p += sizeof(pair);
+                entry = { pair[0], pair[1] };
+            }
+            // 區域表的 t 介於 (0, 1] 且遞增，最後一項為這段曲線的終點；
+            // s 從這段的起點算起，須為有限值、非負且不遞減（寫成 !(a <= b) 是為了讓NaN也不通過）
+            if (table.empty() || !(table.front().first > 0.f) || table.back().first != 1.f || !(table.front().second >= 0.f))
+                fail("BINARY::BAD_ARC_LEN_TABLE");
+            for (size_t k = 1; k < table.size(); ++k) {
+                if (!(table[k - 1].first < table[k].first) || !(table[k - 1].second <= table[k].second))
+                    fail("BINARY::BAD_ARC_LEN_TABLE");
+            }
+            if (!std::isfinite(table.back().second))
+                fail("BINARY::BAD_ARC_LEN_TABLE");
+        }
+    }
+
+    return track;
+}
+
+void write_binary(std::ostream &out, const std::vector<ControlPoint> &control_points,
+                  const ArcLenAccum *accum, SplineType type, float tension, float tolerance)
+{
+    if (accum && accum->segment_num() != control_points.size())
+        accum = nullptr;
+
+    Binary_Header header;
+    std::memcpy(header.magic, Binary_Magic, sizeof(Binary_Magic));
+    header.version = Binary_Version;
+    header.flags = accum ? Has_Arc_Len_Table : 0;
+    header.cp_num = static_cast<uint32_t>(control_points.size());
+    header.spline_type = static_cast<int32_t>(type);
+    header.tension = tension;
+    header.tolerance = tolerance;
+    header.table_entries = 0;
+    if (accum) {
+        for (int n : accum->segment_samples())
+            header.table_entries += static_cast<uint32_t>(n);
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(control_points.data()), control_points.size() * sizeof(ControlPoint));
+
+    if (accum) {
+        std::vector<uint32_t> samples(accum->segment_samples().begin(), accum->segment_samples().end());
+        out.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(uint32_t));
+
+        std::vector<float> flat;
+        flat.reserve(2 * size_t(header.table_entries));
+        for (const auto& table : accum->segment_tables()) {
+            for (const auto& entry : table) {
+                flat.push_back(entry.first);
+                flat.push_back(entry.second);
+            }
+        }
+        out.write(reinterpret_cast<const char*>(flat.data()), flat.size() * sizeof(float));
+    }
+}
+
+std::vector<ControlPoint> read_text(std::istream &in)
+{
+    Chunk_Reader reader(in);
+    return read_control_points(reader);
+}
+
+std::vector<ControlPoint> parse_text(const void *data, size_t size)
+{
+    Buffer_Reader reader(data, size);
+    return read_control_points(reader);
+}
+
+void write_text(std::ostream &out, const std::vector<ControlPoint> &control_points)
+{
+    std::string buf = std::to_string(control_points.size());
+    buf += '\n';
+
+    for (const ControlPoint& cp : control_points) {
+        const float v[6] = { cp.pos.x, cp.pos.y, cp.pos.z, cp.orient.x, cp.orient.y, cp.orient.z };
+        for (int k = 0; k < 6; ++k) {
+            append_float(buf, v[k]);
+            buf += (k == 5) ? '\n' : ' ';
+        }
+
+        // 累積到一塊就寫出
+        if (buf.size() >= Text_Chunk_Size) {
+            out.write(buf.data(), buf.size());
+            buf.clear();
+        }
+    }
+    buf += '\n';
+    out.write(buf.data(), buf.size());
+}
+
+}
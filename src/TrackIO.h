@@ -0,0 +1,109 @@
+/**
+ * @file TrackIO.h
+ * @brief 軌道（控制點）檔案的讀寫
+ */
+#ifndef TRACKIO_H
+#define TRACKIO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "TrackCurve.h"
+
+/**
+ * @brief 軌道檔案的讀寫
+ * @details
+ * 支援兩種格式：
+ *
+ * ## 文字格式（.txt）
+ * 第一個數字為控制點的個數，之後每個控制點依序為 pos.x pos.y pos.z orient.x orient.y orient.z，以空白分隔。
+ * 用 std::from_chars 直接在緩衝區中解析，不經過iostream的格式化；和iostream一樣接受開頭的 '+'，
+ * 個數也可以寫成 "4.0"（但須為整數），inf、nan則視為格式錯誤。
+ *
+ * ## 二進位格式（.trk）
+ * 所有欄位都是4 bytes且對齊4 bytes，byte order同寫入的機器，所以整個檔案可以直接memory map後解析：
+ * ```
+ * Binary_Header                              // 32 bytes
+ * float control_points[cp_num][6]            // pos.xyz, orient.xyz
+ * // 以下只有 flags & Has_Arc_Len_Table 時才有
+ * uint32_t samples[cp_num]                   // 每段曲線的區域表有幾項
+ * float table[table_entries][2]              // 依序接起來的區域表 (t, s)
+ * ```
+ * 曲線長累積表只有在讀入時的 spline 設定（type、tension、tolerance）和寫入時相同才能直接使用，否則要重新積分。
+ *
+ * 格式錯誤時丟出 std::runtime_error。這個namespace不會呼叫任何OpenGL或Qt的函式。
+ */
+namespace TrackIO {
+
+/// 二進位格式的檔頭
+struct Binary_Header {
+    char magic[4];          ///< 固定為 Binary_Magic
+    uint32_t version;       ///< 格式的版本，目前為 Binary_Version
+    uint32_t flags;         ///< 見 Has_Arc_Len_Table
+    uint32_t cp_num;        ///< 控制點的個數
+    int32_t spline_type;    ///< 建立曲線長累積表時的 SplineType
+    float tension;          ///< 建立曲線長累積表時的 cardinal tension
+    float tolerance;        ///< 建立曲線長累積表時每段曲線可接受的誤差
+    uint32_t table_entries; ///< 所有區域表共有幾項
+};
+static_assert(sizeof(Binary_Header) == 32, "Binary_Header must be 32 bytes");
+
+constexpr char Binary_Magic[4] = { 'T', 'R', 'A', 'K' };
+constexpr uint32_t Binary_Version = 1;
+constexpr uint32_t Has_Arc_Len_Table = 1u << 0; ///< 檔案中有曲線長累積表
+
+/// 文字格式每次讀入多少bytes
+constexpr size_t Text_Chunk_Size = 1 << 20;
+
+/// 從檔案讀入的軌道
+struct Track_Data {
+    std::vector<ControlPoint> control_points;
+
+    bool has_arc_len_table = false;              ///< 是否有曲線長累積表，以下欄位只在有表時有效
+    SplineType type = SplineType::LINEAR;
+    float tension = 0.f;
+    float tolerance = 0.f;
+    std::vector<ArcLenAccum::Table_T> tables;    ///< 第i項為第i段曲線的區域表
+
+    /// 曲線長累積表是否可以用在這組spline設定上
+    bool table_matches(SplineType t, float ten, float tol) const
+    { return has_arc_len_table && type == t && tension == ten && tolerance == tol; }
+};
+
+/// 資料的開頭是否為二進位格式的檔頭
+bool is_binary(const void* data, size_t size);
+
+/**
+ * @brief 解析二進位格式
+ * @param data - 整個檔案的內容（可以是memory map的位址）
+ * @param size - 檔案的大小
+ */
+Track_Data parse_binary(const void* data, size_t size);
+
+/**
+ * @brief 寫出二進位格式
+ * @param accum - 曲線長累積表，nullptr表示不寫入；段數須和控制點個數相同
+ * @param type, tension, tolerance - 建立 accum 時的設定
+ */
+void write_binary(std::ostream& out, const std::vector<ControlPoint>& control_points,
+                  const ArcLenAccum* accum, SplineType type, float tension, float tolerance);
+
+/// 讀入文字格式，每次從 in 讀入一塊（Text_Chunk_Size）
+std::vector<ControlPoint> read_text(std::istream& in);
+
+/**
+ * @brief 解析文字格式
+ * @details 同 read_text()，但整個檔案已經在記憶體中（可以是memory map的位址），直接在上面解析不需要複製
+ * @param data - 整個檔案的內容
+ * @param size - 檔案的大小
+ */
+std::vector<ControlPoint> parse_text(const void* data, size_t size);
+
+/// 寫出文字格式
+void write_text(std::ostream& out, const std::vector<ControlPoint>& control_points);
+
+}
+
+#endif // TRACKIO_H
@@ -0,0 +1,150 @@
+#include "TrainFleet.h"
+#include <algorithm>
+#include <cmath>
+
+TrainFleet::TrainFleet(float cart_spacing, float min_gap)
+    : m_next_id(0), m_cart_spacing(cart_spacing), m_min_gap(min_gap), m_distance(), m_S_new()
+{}
+
+int TrainFleet::add(float S, float speed, int cart_num)
+{
+    const size_t i = std::upper_bound(m_S.begin(), m_S.end(), S) - m_S.begin();
+    m_S.insert(m_S.begin() + i, S);
+    m_speed.insert(m_speed.begin() + i, speed);
+    m_cart_num.insert(m_cart_num.begin() + i, cart_num);
+    m_id.insert(m_id.begin() + i, m_next_id);
+    m_moved.insert(m_moved.begin() + i, 0.f);
+    return m_next_id++;
+}
+
+void TrainFleet::remove(size_t i)
+{
+    m_S.erase(m_S.begin() + i);
+    m_speed.erase(m_speed.begin() + i);
+    m_cart_num.erase(m_cart_num.begin() + i);
+    m_id.erase(m_id.begin() + i);
+    m_moved.erase(m_moved.begin() + i);
+}
+
+void TrainFleet::clear()
+{
+    m_S.clear();
+    m_speed.clear();
+    m_cart_num.clear();
+    m_id.clear();
+    m_moved.clear();
+}
+
+size_t TrainFleet::find(int id) const
+{
+    return std::find(m_id.begin(), m_id.end(), id) - m_id.begin();
+}
+
+void TrainFleet::advance(float distance, float length)
+{
+    m_distance.resize(m_S.size());
+    for (size_t i = 0; i < m_distance.size(); ++i)
+        m_distance[i] = distance * m_speed[i];
+    this->advance(m_distance, length);
+}
+
+void TrainFleet::advance(const std::vector<float>& distance, float length)
+{
+    const size_t n = m_S.size();
+    if (n == 0 || length <= 0.f)
+        return;
+
+    // 先不管碰撞，每列火車各自往前（暫時允許超過length）
+    std::vector<float>& S_new = m_S_new;
+    S_new.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        S_new[i] = m_S[i] + distance[i];
+
+    if (n > 1) {
+        // 從最前面的火車往後，讓每列火車停在前車車尾減min_gap的地方
+        // 第n-1列的前車是第0列，要加一圈；第0列的限制又取決於第n-1列，所以掃兩次
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t k = n; k-- > 0;) {
+                const size_t front = (k + 1) % n;
+                const float front_S = (front == 0) ? S_new[0] + length : S_new[front];
+                const float limit = front_S - train_length(front) - m_min_gap;
+                S_new[k] = std::max(m_S[k], std::min(S_new[k], limit)); // 不會後退
+            }
+        }
+    }
+
+    // wrap回 [0, length)
+    for (size_t i = 0; i < n; ++i) {
+        m_moved[i] = S_new[i] - m_S[i];
+        m_S[i] = std::fmod(S_new[i], length);
+        if (m_S[i] < 0.f)
+            m_S[i] += length;
+    }
+
+    // 繞過終點的火車現在位於陣列尾端且S較小，把它們轉到最前面
+    size_t first = 0;
+    for (size_t i = 1; i < n; ++i) {
+        if (m_S[i] < m_S[i - 1]) {
+            first = i;
+            break;
+        }
+    }
+    if (first != 0) {
+        std::rotate(m_S.begin(), m_S.begin() + first, m_S.end());
+        std::rotate(m_speed.begin(), m_speed.begin() + first, m_speed.end());
+        std::rotate(m_cart_num.begin(), m_cart_num.begin() + first, m_cart_num.end());
+        std::rotate(m_id.begin(), m_id.begin() + first, m_id.end());
+        std::rotate(m_moved.begin(), m_moved.begin() + first, m_moved.end());
+    }
+}
+
+void TrainFleet::rescale(float ratio, float length)
+{
+    std::fill(m_moved.begin(), m_moved.end(), 0.f);
+    for (float& S : m_S) {
+        S *= ratio;
+        if (S >= length) // 浮點誤差
+            S = 0.f;
+    }
+    // 只有最後幾列可能因為誤差變成0，重新排序即可
+    if (!std::is_sorted(m_S.begin(), m_S.end())) {
+        std::vector<size_t> order(m_S.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return m_S[a] < m_S[b]; });
+
+        std::vector<float> S(order.size()), speed(order.size());
+        std::vector<int> cart_num(order.size()), id(order.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            S[i] = m_S[order[i]];
+            speed[i] = m_speed[order[i]];
+            cart_num[i] = m_cart_num[order[i]];
+            id[i] = m_id[order[i]];
+        }
+        m_S.swap(S);
+        m_speed.swap(speed);
+        m_cart_num.swap(cart_num);
+        m_id.swap(id);
+    }
+}
+
+float TrainFleet::largest_gap_center(float length) const
+{
+    const size_t n = m_S.size();
+    if (n == 0)
+        return 0.f;
+
+    // 第i列火車的車頭到前車（第i+1列）車尾之間的空隙
+    float best_gap = -1.f, best_center = 0.f;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t front = (i + 1) % n;
+        const float front_tail = ((front == 0) ? m_S[0] + length : m_S[front]) - train_length(front);
+        const float gap = front_tail - m_S[i];
+        if (gap > best_gap) {
+            best_gap = gap;
+            best_center = m_S[i] + 0.5f * gap;
+        }
+    }
+    best_center = std::fmod(best_center, length);
+    return (best_center < 0.f) ? best_center + length : best_center;
+}
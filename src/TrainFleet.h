@@ -0,0 +1,117 @@
+/**
+ * @file TrainFleet.h
+ * @brief 同一條軌道上的多列火車
+ */
+#ifndef TRAINFLEET_H
+#define TRAINFLEET_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief 同一條軌道上的多列火車
+ * @details
+ * 每列火車的資料用structure of arrays存放（第i列火車為 S(i)、speed(i)、cart_num(i)、id(i)），
+ * 並依照車頭的位置S由小到大排好。因為火車不會互相超越，所以每次 advance() 後只需要把繞過終點的幾列轉到最前面，
+ * 排序就能維持，前車永遠是第 i+1 列（最後一列的前車是第0列）。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class TrainFleet
+{
+private:
+    std::vector<float> m_S;      ///< 第i項為第i列火車車頭的實際距離，介於 [0, 軌道長度) 且由小到大
+    std::vector<float> m_speed;  ///< 第i項為第i列火車的速度倍率
+    std::vector<int> m_cart_num; ///< 第i項為第i列火車有幾節車廂
+    std::vector<int> m_id;       ///< 第i項為第i列火車的編號（加入時決定，之後不會變）
+    std::vector<float> m_moved;  ///< 第i項為第i列火車在上一次 advance() 前進了多遠，用來在兩次 advance() 間內插
+    int m_next_id;               ///< 下一列加入的火車的編號
+
+    float m_cart_spacing; ///< 相鄰兩節車廂（含車頭）的距離
+    float m_min_gap;      ///< 前車車尾和後車車頭間至少要隔多遠
+
+    std::vector<float> m_distance; ///< advance(float, float) 時每列火車要前進的距離（重複使用以免每步配置記憶體）
+    std::vector<float> m_S_new;    ///< advance() 時每列火車不管wrap的新位置（重複使用以免每步配置記憶體）
+
+public:
+    /**
+     * @param cart_spacing - 相鄰兩節車廂（含車頭）的距離
+     * @param min_gap - 前車車尾和後車車頭間至少要隔多遠
+     */
+    TrainFleet(float cart_spacing, float min_gap);
+
+    /**
+     * @brief 加入一列火車，並維持排序
+     * @param S - 車頭的位置，須介於 [0, 軌道長度)
+     * @param speed - 速度倍率
+     * @param cart_num - 車廂數量
+     * @return 這列火車的編號
+     */
+    int add(float S, float speed, int cart_num);
+
+    /// 移除第i列火車
+    void remove(size_t i);
+
+    /// 移除所有火車
+    void clear();
+
+    /// 有幾列火車
+    size_t size() const { return m_S.size(); }
+
+    /// 找出編號為id的火車是第幾列，找不到時回傳 size()
+    size_t find(int id) const;
+
+    /// 第i列火車車頭的實際距離
+    float S(size_t i) const { return m_S[i]; }
+    /// 第i列火車的速度倍率
+    float speed(size_t i) const { return m_speed[i]; }
+    /// 第i列火車有幾節車廂
+    int cart_num(size_t i) const { return m_cart_num[i]; }
+    /// 第i列火車的編號
+    int id(size_t i) const { return m_id[i]; }
+    /// 第i列火車在上一次 advance() 前進了多遠
+    float moved(size_t i) const { return m_moved[i]; }
+
+    /// 設定第i列火車的車廂數量
+    void set_cart_num(size_t i, int cart_num) { m_cart_num[i] = cart_num; }
+
+    /// 相鄰兩節車廂（含車頭）的距離
+    float cart_spacing() const { return m_cart_spacing; }
+
+    /// 第i列火車從車頭到車尾佔了多長
+    float train_length(size_t i) const { return (m_cart_num[i] + 1) * m_cart_spacing; }
+
+    /**
+     * @brief 所有火車一起往前
+     * @details
+     * 1. 每列火車前進 distance * speed(i)
+     * 2. 從最前面的火車往後檢查，若車頭會超過前車車尾減 min_gap，則停在那裡（但不會後退）
+     * 3. 繞過終點的火車wrap回 [0, length)，並轉到陣列的最前面以維持排序
+     * @param distance - 速度倍率為1的火車要前進的距離，須大於等於0
+     * @param length - 軌道的長度
+     */
+    void advance(float distance, float length);
+
+    /**
+     * @brief 同 advance(float, float)，但每列火車前進的距離分別指定
+     * @param distance - 第i項為第i列火車不管碰撞時要前進的距離，須大於等於0，共 size() 項
+     * @param length - 軌道的長度
+     */
+    void advance(const std::vector<float>& distance, float length);
+
+    /**
+     * @brief 軌道長度改變時，依比例調整每列火車的位置
+     * @details 位置已經不連續，所以 moved() 都會歸零
+     * @param ratio - 新長度 / 舊長度
+     * @param length - 新的軌道長度
+     */
+    void rescale(float ratio, float length);
+
+    /**
+     * @brief 找出軌道上最大的空隙的中間，用來放新的火車
+     * @param length - 軌道的長度
+     */
+    float largest_gap_center(float length) const;
+};
+
+#endif // TRAINFLEET_H
@@ -0,0 +1,128 @@
+#include "TrainSimulation.h"
+#include <algorithm>
+
+TrainSimulation::TrainSimulation(const TrainFleet &fleet, float step_seconds)
+    : m_fleet(fleet), m_step_seconds(step_seconds), m_distance_per_step(0.f), m_track_length(0.f), m_step_count(0),
+    m_profile(), m_distances(),
+    m_accumulator(0.f), m_last_step(Clock::now()), m_running(false), m_stopping(false)
+{
+}
+
+TrainSimulation::~TrainSimulation()
+{
+    this->stop();
+}
+
+void TrainSimulation::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+        return;
+
+    m_running = true;
+    m_stopping = false;
+    m_last_step = Clock::now();
+    m_thread = std::thread(&TrainSimulation::run, this);
+}
+
+void TrainSimulation::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+            return;
+        m_stopping = true;
+    }
+    m_stop_cv.notify_all();
+    m_thread.join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+    m_accumulator = 0.f;
+}
+
+void TrainSimulation::advance_time(float seconds)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_accumulator += seconds;
+
+    size_t steps = 0;
+    for (; m_accumulator >= m_step_seconds && steps < Max_Catch_Up_Steps; ++steps) {
+        this->step_locked();
+        m_accumulator -= m_step_seconds;
+    }
+    // 補不完的時間直接丟掉
+    m_accumulator = std::min(m_accumulator, m_step_seconds);
+}
+
+void TrainSimulation::set_distance_per_step(float distance)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_distance_per_step = distance;
+}
+
+void TrainSimulation::set_velocity_profile(std::shared_ptr<const VelocityProfile> profile)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profile = std::move(profile);
+}
+
+void TrainSimulation::set_track_length(float length)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (length == m_track_length)
+        return;
+
+    if (m_track_length > 0.f)
+        m_fleet.rescale(length / m_track_length, length);
+    m_track_length = length;
+}
+
+float TrainSimulation::snapshot(TrainFleet &fleet, size_t &step_count) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fleet = m_fleet;
+    step_count = m_step_count;
+
+    const float elapsed = m_running ? std::chrono::duration<float>(Clock::now() - m_last_step).count()
+                                    : m_accumulator;
+    return std::min(std::max(elapsed / m_step_seconds, 0.f), 1.f);
+}
+
+void TrainSimulation::step_locked()
+{
+    if (m_profile) {
+        // 每列火車依所在位置查表，再乘上自己的速度倍率
+        m_distances.resize(m_fleet.size());
+        for (size_t i = 0; i < m_fleet.size(); ++i)
+            m_distances[i] = m_profile->at(m_fleet.S(i)) * m_fleet.speed(i) * m_step_seconds;
+        m_fleet.advance(m_distances, m_track_length);
+    }
+    else {
+        m_fleet.advance(m_distance_per_step, m_track_length);
+    }
+    ++m_step_count;
+}
+
+void TrainSimulation::run()
+{
+    const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(m_step_seconds));
+    auto next = Clock::now() + step;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        // 等到下一步的時間，或被要求結束
+        if (m_stop_cv.wait_until(lock, next, [this]() { return m_stopping; }))
+            break;
+
+        // 落後太多時丟掉多的時間
+        const auto now = Clock::now();
+        if (now - next >= step * static_cast<int>(Max_Catch_Up_Steps))
+            next = now - step * static_cast<int>(Max_Catch_Up_Steps - 1);
+
+        for (; next <= now && !m_stopping; next += step) {
+            this->step_locked();
+            m_last_step = next;
+        }
+    }
+}
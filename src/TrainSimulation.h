@@ -0,0 +1,130 @@
+/**
+ * @file TrainSimulation.h
+ * @brief 以固定時間間隔推進的火車模擬
+ */
+#ifndef TRAINSIMULATION_H
+#define TRAINSIMULATION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include "TrainFleet.h"
+#include "VelocityProfile.h"
+
+/**
+ * @brief 以固定時間間隔推進的火車模擬
+ * @details
+ * 每一步固定經過 step_seconds 秒，火車（速度倍率為1時）前進 distance_per_step，
+ * 所以火車的速度不受畫面更新的頻率或繪製所花的時間影響。
+ * 設定了速度表（set_velocity_profile()）時，則改為每列火車依所在位置查表，前進 速度 * 速度倍率 * step_seconds。
+ *
+ * 有兩種推進的方式：
+ * - start() 開一個thread，每隔 step_seconds 自動前進一步，模擬不會佔用繪圖的thread
+ * - 不開thread，由呼叫者用 advance_time() 告訴它經過了多少時間
+ *
+ * 繪圖時用 snapshot() 取得最新的狀態，以及距離上一步已經過了幾分之幾步；
+ * 再用 S(i) - (1 - alpha) * moved(i) 在上一步和這一步間內插。
+ *
+ * 所有函式都可以在任何thread呼叫。這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class TrainSimulation
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// 一次呼叫最多補幾步，太慢時丟掉多的時間，避免越補越慢
+    static constexpr size_t Max_Catch_Up_Steps = 10;
+
+private:
+    TrainFleet m_fleet;        ///< 火車的狀態
+    float m_step_seconds;      ///< 每一步經過多少秒
+    float m_distance_per_step; ///< 速度倍率為1的火車每一步前進多遠
+    float m_track_length;      ///< 軌道的長度
+    size_t m_step_count;       ///< 總共前進了幾步
+    std::shared_ptr<const VelocityProfile> m_profile; ///< 速度表，nullptr時以 m_distance_per_step 前進
+    std::vector<float> m_distances; ///< 每一步各列火車要前進的距離（重複使用以免每步配置記憶體）
+
+    float m_accumulator;             ///< advance_time() 累積但還不到一步的時間（秒）
+    Clock::time_point m_last_step;   ///< thread最後一次前進的時間
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_stop_cv;
+    std::thread m_thread;
+    bool m_running;   ///< 是否開了thread
+    bool m_stopping;  ///< 要求thread結束
+
+public:
+    /**
+     * @param fleet - 一開始的火車
+     * @param step_seconds - 每一步經過多少秒
+     */
+    TrainSimulation(const TrainFleet& fleet, float step_seconds);
+
+    /// 會先呼叫 stop()
+    ~TrainSimulation();
+
+    TrainSimulation(const TrainSimulation&) = delete;
+    TrainSimulation& operator=(const TrainSimulation&) = delete;
+
+    /// 開一個thread，每隔 step_seconds 自動前進一步；已經開了則什麼都不做
+    void start();
+
+    /// 停止並等待thread結束
+    void stop();
+
+    /**
+     * @brief 經過了seconds秒，前進對應的步數（最多 Max_Catch_Up_Steps 步）
+     * @note 開了thread時不需要呼叫
+     */
+    void advance_time(float seconds);
+
+    /// 設定速度倍率為1的火車每一步前進多遠，須大於等於0
+    void set_distance_per_step(float distance);
+
+    /// 每一步經過多少秒
+    float step_seconds() const { return m_step_seconds; }
+
+    /**
+     * @brief 設定速度表
+     * @param profile - 速度表，建好後不可再修改；nullptr表示改回以 distance_per_step 前進
+     */
+    void set_velocity_profile(std::shared_ptr<const VelocityProfile> profile);
+
+    /**
+     * @brief 設定軌道的長度
+     * @details 和原本的長度不同時，依比例調整每列火車的位置
+     */
+    void set_track_length(float length);
+
+    /**
+     * @brief 修改火車（加入火車、增加車廂等）
+     * @param f - 以 TrainFleet& 為參數的函式，呼叫時已經上鎖
+     */
+    template <class F>
+    void edit(F f)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        f(m_fleet);
+    }
+
+    /**
+     * @brief 取得最新的狀態
+     * @param[out] fleet - 複製最新的火車狀態
+     * @param[out] step_count - 總共前進了幾步
+     * @return 距離最新的一步已經過了幾分之幾步，介於 [0, 1]
+     */
+    float snapshot(TrainFleet& fleet, size_t& step_count) const;
+
+private:
+    /// 前進一步，須先上鎖
+    void step_locked();
+
+    /// thread執行的函式
+    void run();
+};
+
+#endif // TRAINSIMULATION_H
@@ -3,102 +3,118 @@
 #include <glad/gl.h>
 #include <glm/trigonometric.hpp>
 #include <glm/geometric.hpp>
+#include <glm/common.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <QMessageBox>
+#include <QFile>
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 #include <stdlib.h>
 #include <ArcBall.h>
+#include "TrackIO.h"
 
 /// Control Point的大小
 constexpr float CONTROL_POINT_SIZE = 0.2f;
-/// 大小的斜邊
-constexpr float HYPOT_CP_SIZE = 1.41421f /*sqrt(2)*/ * CONTROL_POINT_SIZE;
+/// 點擊時每個控制點的box：[pos - CP_Box_Lower, pos + CP_Box_Upper]，垂直方向包含頂端的尖角
+const glm::vec3 CP_Box_Lower(CONTROL_POINT_SIZE, CONTROL_POINT_SIZE, CONTROL_POINT_SIZE);
+const glm::vec3 CP_Box_Upper(CONTROL_POINT_SIZE, 3 * CONTROL_POINT_SIZE, CONTROL_POINT_SIZE);
+/// 射線打到box的交點有浮點數誤差，選取時box往外多留這麼多
+constexpr float CP_Pick_Epsilon = 0.01f * CONTROL_POINT_SIZE;
+/// 火車模型的縮放
+constexpr float Train_Scale = 1.5f * CONTROL_POINT_SIZE;
 
 constexpr float Track_Interval = 0.2f;
-constexpr float Param_Interval = 0.0625f;
+/// 座標系表中相鄰兩個座標系的距離
+constexpr float Frame_Interval = 0.25f * Track_Interval;
+/// 額外的支柱間的距離
+constexpr float Pillar_Interval = 2.f;
+/// 相鄰兩節車廂（含車頭）的距離
+constexpr float Cart_Spacing = 5 * CONTROL_POINT_SIZE;
+/// 主火車的編號（第一列加入的火車）
+constexpr int Main_Train_ID = 0;
+/// 火車模擬每一步經過多少秒
+constexpr float Sim_Step = 0.02f;
+/// 最多同時有幾個煙的粒子
+constexpr size_t Smoke_Capacity = 1024;
+/// 最多同時有幾個蒸氣的粒子
+constexpr size_t Steam_Capacity = 64;
+/// 所有粒子特效加起來最多同時有幾個粒子：每個發射點的容量相加（主火車的煙和蒸氣），多配的格子只會浪費GPU記憶體
+constexpr size_t Particle_Capacity = Smoke_Capacity + Steam_Capacity;
+/// 煙的貼圖在粒子 texture array 的第幾層
+constexpr GLuint Smoke_Layer = 0;
+
+/// 物理模式：重力加速度、摩擦係數、lift的速度、煞車限制的最高速度
+constexpr float Gravity = 9.8f;
+constexpr float Friction = 0.02f;
+constexpr float Lift_Speed = 1.5f;
+constexpr float Max_Speed = 10.f;
+
+/// 幾個模型合起來的bounding box（模型座標）
+static void model_bounds(const Model* models, size_t num, glm::vec3& min, glm::vec3& max)
+{
+    std::vector<glm::vec3> triangles;
+    for (size_t i = 0; i < num; ++i)
+        models[i].append_triangles(triangles);
+
+    min = glm::vec3(RayCast::No_Hit);
+    max = glm::vec3(-RayCast::No_Hit);
+    for (const glm::vec3& p : triangles) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+}
+
+/// 只有主火車的車隊
+static TrainFleet make_main_fleet()
+{
+    TrainFleet fleet(Cart_Spacing, CONTROL_POINT_SIZE);
+    fleet.add(0.f, 1.f, 0);
+    return fleet;
+}
 
 // Arc Len Accum ////////////////////////////////////////////////////////////////
 
-float TrainSystem::T_to_S(float T) const
+void TrainSystem::update_arc_len_accum()
 {
-    /// @note 超出範圍時，做wrap
-    while (T < 0) T += m_Arc_Len_Accum.back().first;
-    while (T >= m_Arc_Len_Accum.back().first) T -= m_Arc_Len_Accum.back().first;
-
-    /// @note 處理極端特例，當T很接近0或最大參數時，回傳0
-    if (fabs(T) < 1.e-4 || fabs(T - m_Arc_Len_Accum.back().first) < 1.e-4) return 0;
-
-    for (size_t i = 0; i < m_Arc_Len_Accum.size() - 1; ++i) {
-        const float lowU = m_Arc_Len_Accum[i].first;
-        const float highU = m_Arc_Len_Accum[i + 1].first;
-        if (lowU <= T && T < highU) {
-            const float lowS = m_Arc_Len_Accum[i].second;
-            const float highS = m_Arc_Len_Accum[i + 1].second;
-            return lowS + (T - lowU) / (highU - lowU) * (highS - lowS);
-        }
-    }
-
-    assert(false); // should not go here
-    return NAN;
+    m_track.rebuild(m_control_points, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
+    m_please_update_arc_len_accum = false;
 }
 
-float TrainSystem::S_to_T(float S) const
+void TrainSystem::update_frames()
 {
-    /// @note 超出範圍時，做wrap
-    while (S < 0) S += m_Arc_Len_Accum.back().second;
-    while (S >= m_Arc_Len_Accum.back().second) S -= m_Arc_Len_Accum.back().second;
-
-    /// @note 處理極端特例，當S很接近0或最大長度時，回傳0
-    if (fabs(S) < 1.e-4 || fabs(S - m_Arc_Len_Accum.back().second) < 1.e-4) return 0;
-
-    // （實際空間） 轉回 （參數空間）
-    for (size_t i = 0; i < m_Arc_Len_Accum.size() - 1; ++i) {
-        const float lowS = m_Arc_Len_Accum[i].second;
-        const float highS = m_Arc_Len_Accum[i + 1].second;
-        if ((lowS <= S && S < highS)) {
-            const float lowU = m_Arc_Len_Accum[i].first;
-            const float highU = m_Arc_Len_Accum[i + 1].first;
-            return lowU + (S - lowS) / (highS - lowS) * (highU - lowU);
-        }
+    if (m_frame_revision != m_track.revision()) {
+        m_frames.rebuild(m_track);
+        m_frame_revision = m_track.revision();
+        if (m_velocity_profile)
+            this->update_velocity_profile();
     }
+}
 
-    assert(false); // should not go here
-    return NAN;
+void TrainSystem::update_velocity_profile()
+{
+    auto profile = std::make_shared<VelocityProfile>(Frame_Interval, Gravity, Friction, Lift_Speed, Max_Speed);
+    profile->rebuild(m_frames);
+
+    m_velocity_profile = profile;
+    m_sim.set_velocity_profile(profile);
+    emit lap_time_changed(profile->lap_time());
 }
 
-void TrainSystem::update_arc_len_accum()
+void TrainSystem::toggle_physics(bool on)
 {
-    // reset
-    m_Arc_Len_Accum.clear();
-    m_Arc_Len_Accum.reserve(m_control_points.size() * 16 + 1);
-    m_Arc_Len_Accum.emplace_back(std::pair<float, float>{ 0, 0 });
-
-    // for each control point
-    for (size_t cp_id = 0; cp_id < m_control_points.size(); ++cp_id) {
-        Draw::Param_Equation point_eq, unused;
-        set_equation(cp_id, point_eq, unused);
-
-        glm::vec3 p1 = point_eq(0);
-        for (float t = Param_Interval; t <= 1; t += Param_Interval) {
-            glm::vec3 p2 = point_eq(t);
-            glm::vec3 delta = p2 - p1;
-            float len = sqrtf(delta.x * delta.x + delta.y * delta.y + delta.z * delta.z);
-
-            m_Arc_Len_Accum.emplace_back(std::pair<float, float>{
-                cp_id + t,
-                len + m_Arc_Len_Accum.back().second
-            });
-
-            // store it for next iteration
-            p1 = p2;
-        }
+    if (on) {
+        this->update_frames();
+        this->update_velocity_profile();
+    }
+    else {
+        m_velocity_profile.reset();
+        m_sim.set_velocity_profile(nullptr);
+        emit lap_time_changed(0.f);
     }
-
-    m_please_update_arc_len_accum = false;
 }
 
 
@@ -106,26 +122,54 @@ void TrainSystem::update_arc_len_accum()
 
 bool TrainSystem::process_click(glm::vec3 pos)
 {
-    m_selected_control_point = -1;
-
-    for (int i = 0; i < m_control_points.size(); ++i) {
-        glm::vec3 delta = pos - m_control_points[i].pos;
-        float horizontal_d = std::hypot(delta.x, delta.z); // 水平距離
-        float vertical_d = std::abs(delta.y); // 垂直距離
+    const glm::vec3 epsilon(CP_Pick_Epsilon);
+    m_selected_control_point = m_cp_grid.pick(pos, CP_Box_Lower + epsilon, CP_Box_Upper + epsilon);
 
-        if (horizontal_d < HYPOT_CP_SIZE && vertical_d < 3 * CONTROL_POINT_SIZE) {
-            m_selected_control_point = i;
-            std::cout << "Select Control Point: " << m_selected_control_point << std::endl;
+    if (m_selected_control_point >= 0) {
+        std::cout << "Select Control Point: " << m_selected_control_point << std::endl;
 
-            emit is_point_selected(true);
-            return true;
-        }
+        emit is_point_selected(true);
+        return true;
     }
 
     emit is_point_selected(false);
     return false;
 }
 
+float TrainSystem::ray_cast(const Ray &ray)
+{
+    float best = RayCast::No_Hit;
+
+    // 控制點：和 process_click() 選取的範圍相同的box
+    for (const ControlPoint& cp : m_control_points)
+        best = std::min(best, RayCast::box(ray, cp.pos - CP_Box_Lower, cp.pos + CP_Box_Upper));
+
+    // 鐵軌、枕木和支柱：和上次 draw() 時建的mesh相同（鐵軌的三角形現算，不另外存一份）
+    if (m_please_update_track_bvh) {
+        std::vector<glm::vec3> triangles;
+        m_rail_VAO.append_triangles(m_track, triangles);
+        m_sleeper_VAO.append_triangles(triangles);
+        m_pillar_VAO.append_triangles(triangles, CONTROL_POINT_SIZE);
+        m_track_bvh = TriangleBVH(std::move(triangles));
+        m_please_update_track_bvh = false;
+    }
+    best = std::min(best, m_track_bvh.intersect(ray));
+
+    // 火車：把射線轉到車廂的模型座標（同 train.vert，座標系是正交的，所以 t 不變）
+    for (size_t k = 0; k < m_render_fleet.size(); ++k) {
+        const size_t num = this->update_cart_frames(k);
+        for (size_t i = 0; i < num; ++i) {
+            const FrameTable::Frame& f = m_cart_frames[i];
+            const glm::vec3 origin = ray.origin - f.pos;
+            const Ray local{ glm::vec3(glm::dot(origin, f.FRONT), glm::dot(origin, f.TOP), glm::dot(origin, f.LEFT)) / Train_Scale,
+                             glm::vec3(glm::dot(ray.dir, f.FRONT), glm::dot(ray.dir, f.TOP), glm::dot(ray.dir, f.LEFT)) / Train_Scale };
+            best = std::min(best, i == 0 ? RayCast::box(local, m_train_min, m_train_max)
+                                         : RayCast::box(local, m_cart_min, m_cart_max));
+        }
+    }
+    return best;
+}
+
 bool TrainSystem::process_drag(glm::vec3 eye, glm::vec3 pos)
 {
     if (nothing_is_selected())
@@ -155,7 +199,11 @@ bool TrainSystem::process_drag(glm::vec3 eye, glm::vec3 pos)
         m_control_points[m_selected_control_point].pos = new_cp_pos;
     }
 
-    m_please_update_arc_len_accum = true;
+    m_cp_grid.move(m_selected_control_point, m_control_points[m_selected_control_point].pos);
+
+    // 只重算這個控制點附近的曲線
+    if (!m_please_update_arc_len_accum)
+        m_track.update_control_point(m_control_points, m_selected_control_point, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
     return true;
 }
 
@@ -168,6 +216,9 @@ void TrainSystem::add_CP()
         glm::vec3 new_pos = 0.5f * (m_control_points.front().pos + m_control_points.back().pos);
 
         m_control_points.emplace_back(ControlPoint{new_pos, glm::vec3(0, 1, 0)});
+        m_cp_grid.rebuild(m_control_points);
+        if (!m_please_update_arc_len_accum)
+            m_track.insert_control_point(m_control_points, m_control_points.size() - 1, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
 
         emit is_point_selected(false);
     }
@@ -179,11 +230,12 @@ void TrainSystem::add_CP()
         new_cp.orient = glm::vec3(0, 1, 0);
 
         m_control_points.insert(m_control_points.begin() + selected + 1, new_cp);
+        m_cp_grid.rebuild(m_control_points); // 之後的index都位移了
+        if (!m_please_update_arc_len_accum)
+            m_track.insert_control_point(m_control_points, selected + 1, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
 
         emit is_point_selected(true);
     }
-
-    m_please_update_arc_len_accum = true;
 }
 
 void TrainSystem::delete_CP()
@@ -194,13 +246,14 @@ void TrainSystem::delete_CP()
     if (m_control_points.size() <= 4) return;
 
     m_control_points.erase(m_control_points.begin() + m_selected_control_point);
+    m_cp_grid.rebuild(m_control_points); // 之後的index都位移了
+    if (!m_please_update_arc_len_accum)
+        m_track.erase_control_point(m_control_points, m_selected_control_point, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
 
     // 原本位置上的控制點被刪了，並由後一項遞補
     // 所以m_selected_control_point不用加1就已經指到原本的後一項
     m_selected_control_point %= m_control_points.size();
     emit is_point_selected(true);
-
-    m_please_update_arc_len_accum = true;
 }
 
 void TrainSystem::reset_CP()
@@ -209,6 +262,7 @@ void TrainSystem::reset_CP()
                              {glm::vec3(0, 0, 2), glm::vec3(0, 1, 0)},
                              {glm::vec3(-2, 0, 0), glm::vec3(0, 1, 0)},
                              {glm::vec3(0, 0, -2), glm::vec3(0, 1, 0)}});
+    m_cp_grid.rebuild(m_control_points);
 
     m_please_update_arc_len_accum = true;
 }
@@ -237,54 +291,78 @@ void TrainSystem::set_orient_for_selected_CP(float alpha, float beta)
     ArcBall ball(glm::vec3(0, 0, 0), 1.f, alpha, beta);
     m_control_points[m_selected_control_point].orient = ball.calc_pos();
 
-    m_please_update_arc_len_accum = true;
+    if (!m_please_update_arc_len_accum)
+        m_track.update_control_point(m_control_points, m_selected_control_point, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
 }
 
 void TrainSystem::import_control_points(std::string path)
 {
-    std::ifstream inFile(path);
-
-    if (!inFile.is_open()) {
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::ReadOnly)) {
         QMessageBox::critical(nullptr, "Failed", u8"無法開啟檔案");
         return;
     }
 
-    int num = 0;
-    inFile >> num;
-    if (num < 4) {
+    TrackIO::Track_Data track;
+    try {
+        // memory map後直接在上面解析；無法map（如空檔案）時才逐塊讀入
+        const qint64 size = file.size();
+        const uchar* data = (size > 0) ? file.map(0, size) : nullptr;
+        if (data && TrackIO::is_binary(data, static_cast<size_t>(size))) {
+            track = TrackIO::parse_binary(data, static_cast<size_t>(size));
+        }
+        else if (data) {
+            track.control_points = TrackIO::parse_text(data, static_cast<size_t>(size));
+        }
+        else {
+            std::ifstream inFile(path, std::ios::binary);
+            track.control_points = TrackIO::read_text(inFile);
+        }
+    }
+    catch (std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
         QMessageBox::critical(nullptr, "Failed", u8"檔案格式不符");
         return;
     }
 
-    m_control_points.resize(num);
-    for (int i = 0; i < num; ++i) {
-        ControlPoint& cp = m_control_points[i];
-        inFile >> cp.pos.x >> cp.pos.y >> cp.pos.z
-            >> cp.orient.x >> cp.orient.y >> cp.orient.z;
+    if (track.control_points.size() < 4) {
+        QMessageBox::critical(nullptr, "Failed", u8"檔案格式不符");
+        return;
     }
+    m_control_points = std::move(track.control_points);
+    m_cp_grid.rebuild(m_control_points);
 
     m_selected_control_point = -1;
     emit is_point_selected(false);
 
-    m_please_update_arc_len_accum = true;
+    // 檔案中的曲線長累積表和現在的設定相同時直接使用，不用重新積分
+    if (track.table_matches(m_line_type, m_cardinal_tension, m_arc_len_tolerance)) {
+        m_track.rebuild(m_control_points, m_line_type, m_cardinal_tension, std::move(track.tables));
+        m_please_update_arc_len_accum = false;
+    }
+    else {
+        m_please_update_arc_len_accum = true;
+    }
 }
 
 void TrainSystem::export_control_points(std::string path) const
 {
-    std::ofstream outFile(path);
+    const bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".trk") == 0;
+    std::ofstream outFile(path, binary ? std::ios::binary : std::ios::out);
 
     if (!outFile.is_open()) {
         QMessageBox::critical(nullptr, "Failed", u8"無法開啟檔案");
         return;
     }
 
-    outFile << m_control_points.size() << '\n';
-    for (auto it = m_control_points.begin(); it != m_control_points.end(); ++it) {
-        outFile << it->pos.x << ' ' << it->pos.y << ' ' << it->pos.z << ' '
-                << it->orient.x << ' ' << it->orient.y << ' ' << it->orient.z << '\n';
+    if (binary) {
+        // m_track 是最新的才一起寫入曲線長累積表
+        const ArcLenAccum* accum = m_please_update_arc_len_accum ? nullptr : &m_track.arc_len_accum();
+        TrackIO::write_binary(outFile, m_control_points, accum, m_line_type, m_cardinal_tension, m_arc_len_tolerance);
+    }
+    else {
+        TrackIO::write_text(outFile, m_control_points);
     }
-
-    outFile << std::endl;
 }
 
 // Ctor /////////////////////////////////////////////////////////////////////////////////////////
@@ -294,25 +372,36 @@ TrainSystem::TrainSystem()
     : m_control_points(),
     m_selected_control_point(-1), m_control_point_VAO(CONTROL_POINT_SIZE),
     m_control_point_shader("shader/control_point.vert", nullptr, nullptr, nullptr, "shader/control_point.frag"),
+    m_cp_instance_revision(static_cast<size_t>(-1)), m_cp_instance_selected(-1), m_cp_grid(4 * CONTROL_POINT_SIZE),
     // line type初始化
     m_line_type(SplineType::LINEAR), m_cardinal_tension(0.5f),
-    m_Arc_Len_Accum(),
+    m_track(), m_arc_len_tolerance(1.e-3f),
+    m_frames(Frame_Interval), m_frame_revision(static_cast<size_t>(-1)), m_velocity_profile(),
+    // 鐵軌初始化
+    m_rail_VAO(CONTROL_POINT_SIZE, 0.15f * CONTROL_POINT_SIZE, 0.25f * CONTROL_POINT_SIZE, 64),
+    m_rail_shader("shader/rail.vert", nullptr, nullptr, nullptr, "shader/track.frag"),
+    m_rail_revision(static_cast<size_t>(-1)),
+    // 枕木初始化
+    m_sleeper_VAO(CONTROL_POINT_SIZE, Track_Interval),
+    m_sleeper_shader("shader/sleeper.vert", nullptr, nullptr, nullptr, "shader/track.frag"),
+    m_sleeper_revision(static_cast<size_t>(-1)),
     // 木頭支柱初始化
     m_wood_shader("shader/wood.vert", nullptr, nullptr, nullptr, "shader/wood.frag"),
     m_wood_cube(":/wood.jpg", ":/wood.jpg", ":/wood.jpg", ":/wood.jpg", ":/wood.jpg", ":/wood.jpg"),
-    m_unit_box_VAO(1.f),
+    m_pillar_VAO(), m_extra_pillars(false), m_pillar_revision(static_cast<size_t>(-1)),
+    m_track_bvh(), m_please_update_track_bvh(false),
     // 位置初始化
-    m_train_pos(0, 0, 0), m_trainU(0.f),
+    m_train_pos(0, 0, 0), m_sim(make_main_fleet(), Sim_Step), m_render_fleet(Cart_Spacing, CONTROL_POINT_SIZE),
+    m_render_alpha(1.f), m_synced_step(0), m_cart_offsets(), m_cart_frames(),
     // 車子模型初始化
     m_train_models{ Model("asset/model/train/train.fbx"), Model("asset/model/train/train1.fbx"), Model("asset/model/train/train2.fbx"),
                    Model("asset/model/train/train3.fbx"), Model("asset/model/train/train4.fbx"), Model("asset/model/train/train5.fbx")},
     m_cart_models{ Model("asset/model/cart/cart.fbx"), Model("asset/model/cart/cart1.fbx"), Model("asset/model/cart/cart2.fbx"),
                    Model("asset/model/cart/cart3.fbx"), Model("asset/model/cart/cart4.fbx"), Model("asset/model/cart/cart5.fbx")},
-    m_which_train(0), m_cart_num(0),
-    // smoke
-    m_smoke_obj([](const glm::vec3& pos, unsigned TTL)->glm::vec3 {
-        return glm::vec3(pos.x, pos.y + TTL * CONTROL_POINT_SIZE * 0.02f, pos.z);
-    }, CONTROL_POINT_SIZE, ":/smoke.png"), m_smoke_counter(0),
+    m_train_min(0), m_train_max(0), m_cart_min(0), m_cart_max(0),
+    m_which_train(0),
+    // 粒子特效
+    m_particles({ ":/smoke.png" }, Particle_Capacity), m_smoke_emitter(0), m_steam_emitter(0), m_smoke_counter(0),
     // shader
     m_train_shader("shader/train.vert", nullptr, nullptr, nullptr, "shader/train.frag"),
     // flag 初始化
@@ -320,41 +409,125 @@ TrainSystem::TrainSystem()
 {
     this->reset_CP();
 
-    glUseProgram(m_wood_shader.Program);
-    glUniform1i(glGetUniformLocation(m_wood_shader.Program, "wood"), 0);
-    glUseProgram(0);
-
-    glUseProgram(m_train_shader.Program);
-    glUniform1i(glGetUniformLocation(m_train_shader.Program, "diffuse"), 0);
-    glUseProgram(0);
+    // 鐵軌和枕木用同一個fragment shader，只有材質不同
+    m_rail_shader.uniform<glm::vec4>("color").set(glm::vec4(0.25f, 0.25f, 0.28f, 1.f));
+    m_rail_shader.uniform<glm::vec4>("color_specular").set(glm::vec4(0.6f, 0.6f, 0.6f, 1.f));
+    m_rail_shader.uniform<GLfloat>("shininess").set(64.f);
+    m_sleeper_shader.uniform<glm::vec4>("color").set(glm::vec4(0.9f, 0.9f, 0.9f, 1.f));
+    m_sleeper_shader.uniform<glm::vec4>("color_specular").set(glm::vec4(0.2f, 0.2f, 0.2f, 1.f));
+    m_sleeper_shader.uniform<GLfloat>("shininess").set(16.f);
+
+    m_wood_shader.uniform<GLint>("wood").set(0);
+    m_wood_shader.uniform<GLfloat>("cp_size").set(CONTROL_POINT_SIZE);
+
+    m_train_shader.uniform<GLint>("diffuse").set(0);
+    m_train_shader.uniform<GLfloat>("scale").set(Train_Scale);
+    m_train_uniforms.index = m_train_shader.uniform<GLint>("index");
+    m_train_uniforms.translate = m_train_shader.uniform<glm::vec3>("translate");
+    m_train_uniforms.FRONT = m_train_shader.uniform<glm::vec3>("FRONT");
+    m_train_uniforms.LEFT = m_train_shader.uniform<glm::vec3>("LEFT");
+    m_train_uniforms.TOP = m_train_shader.uniform<glm::vec3>("TOP");
+
+    // 煙往上飄，越新的煙（TTL越大）飄得越快
+    GPUParticle::Effect smoke{ CONTROL_POINT_SIZE, Smoke_Layer };
+    smoke.velocity_per_TTL = glm::vec3(0, CONTROL_POINT_SIZE * 0.02f, 0);
+    m_smoke_emitter = m_particles.add_emitter(m_particles.add_effect(smoke), Smoke_Capacity);
+
+    // 蒸氣從車頭兩側噴出，往上飄並被風吹走（越高風越大），很快就消失；在CPU上模擬，死掉的粒子會立刻移除
+    GPUParticle::Effect steam{ 0.4f * CONTROL_POINT_SIZE, Smoke_Layer };
+    steam.transform = ParticleTransform::combine(ParticleTransform::buoyancy(glm::vec3(0, CONTROL_POINT_SIZE * 0.01f, 0)),
+                                                 ParticleTransform::wind(glm::vec3(CONTROL_POINT_SIZE * 0.05f, 0, 0),
+                                                                         10 * CONTROL_POINT_SIZE));
+    m_steam_emitter = m_particles.add_emitter(m_particles.add_effect(steam), Steam_Capacity);
+
+    model_bounds(m_train_models, 6, m_train_min, m_train_max);
+    model_bounds(m_cart_models, 6, m_cart_min, m_cart_max);
 
     this->update_arc_len_accum();
-    this->updateTrainPos(0);
+    this->sync_trains();
 }
 
-void TrainSystem::updateTrainPos(float distance)
+void TrainSystem::sync_trains()
 {
     if (m_please_update_arc_len_accum)
         this->update_arc_len_accum();
+    this->update_frames();
+
+    // 軌道長度改變時，模擬會依比例調整所有火車的位置
+    m_sim.set_track_length(m_track.length());
+
+    size_t step_count;
+    m_render_alpha = m_sim.snapshot(m_render_fleet, step_count);
+    const size_t steps = std::min(step_count - m_synced_step, TrainSimulation::Max_Catch_Up_Steps);
+    m_synced_step = step_count;
+
+    const size_t main = m_render_fleet.find(Main_Train_ID);
+    const FrameTable::Frame head = m_frames.at(this->render_S(main));
+    m_train_pos = head.pos;
+
+    const bool moving = m_render_fleet.moved(main) > 0.f;
+    for (size_t k = 0; k < steps; ++k) {
+        if (moving) {
+            m_which_train = (m_which_train + 1) % 6;
+            m_smoke_counter = (m_smoke_counter + 1) % 5;
+            if (m_smoke_counter == 0) // 只有主火車會冒煙
+                m_particles.spawn(m_smoke_emitter, head.pos + (4.1f * CONTROL_POINT_SIZE) * head.TOP, 25);
+            // 每一步輪流從左右兩側噴蒸氣
+            const float side = (m_which_train % 2 == 0) ? 1.f : -1.f;
+            m_particles.spawn(m_steam_emitter, head.pos + CONTROL_POINT_SIZE * (head.TOP + side * head.LEFT), 15);
+        }
+        else {
+            m_smoke_counter = 1;  // 如果火車沒有前進，則避免counter歸零，這樣就不會加入更多的smoke
+        }
 
-    float S = T_to_S(m_trainU);
-    S += distance;
-    m_trainU = S_to_T(S);
+        m_particles.update();
+    }
+}
+
+void TrainSystem::add_cart()
+{
+    m_sim.edit([](TrainFleet& fleet) {
+        const size_t i = fleet.find(Main_Train_ID);
+        fleet.set_cart_num(i, fleet.cart_num(i) + 1);
+    });
+}
 
-    int cp_id = floor(m_trainU);
-    Draw::Param_Equation pos_eq, orient_eq;
-    set_equation(cp_id, pos_eq, orient_eq);
-    m_train_pos = pos_eq(m_trainU - cp_id);
+void TrainSystem::delete_cart()
+{
+    m_sim.edit([](TrainFleet& fleet) {
+        const size_t i = fleet.find(Main_Train_ID);
+        fleet.set_cart_num(i, std::max(fleet.cart_num(i) - 1, 0));
+    });
+}
 
-    if (distance > 0) {
-        m_which_train = (m_which_train + 1) % 6;
-        m_smoke_counter = (m_smoke_counter + 1) % 5;
-    }
-    else {
-        m_smoke_counter = 1;  // 如果火車沒有前進，則避免counter歸零，這樣draw_train時就不會加入更多的smoke
-    }
+void TrainSystem::clear_cart()
+{
+    m_sim.edit([](TrainFleet& fleet) { fleet.set_cart_num(fleet.find(Main_Train_ID), 0); });
+}
 
-    m_smoke_obj.update();
+void TrainSystem::add_train()
+{
+    const float length = m_track.length();
+    m_sim.edit([length](TrainFleet& fleet) {
+        // 每列火車的速度倍率在 0.5 ~ 1.0 之間，快車追上慢車時就會在後面排隊
+        const int n = static_cast<int>(fleet.size());
+        const float speed = 0.5f + 0.05f * ((n * 7) % 11);
+        fleet.add(fleet.largest_gap_center(length), speed, fleet.cart_num(fleet.find(Main_Train_ID)));
+    });
+}
+
+void TrainSystem::delete_train()
+{
+    m_sim.edit([](TrainFleet& fleet) {
+        // 找出編號最大（最後加入）的火車
+        size_t last = fleet.size();
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            if (fleet.id(i) != Main_Train_ID && (last == fleet.size() || fleet.id(i) > fleet.id(last)))
+                last = i;
+        }
+        if (last != fleet.size())
+            fleet.remove(last);
+    });
 }
 
 // Draw //////////////////////////////////////////////////////////////////////////////////////////
@@ -363,6 +536,7 @@ void TrainSystem::draw(bool wireframe)
 {
     if (m_please_update_arc_len_accum)
         this->update_arc_len_accum();
+    this->update_frames();
 
     glUseProgram(0);
     glBindVertexArray(0);
@@ -376,7 +550,7 @@ void TrainSystem::draw(bool wireframe)
     this->draw_sleeper();
     this->draw_train_with_shader();
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    m_smoke_obj.draw();
+    m_particles.draw();
 
     if (wireframe)
         this->draw_control_points_with_shader(true); // 畫一個透明的控制點
@@ -384,55 +558,60 @@ void TrainSystem::draw(bool wireframe)
 
 void TrainSystem::draw_control_points_with_shader(bool transparent)
 {
+    // 控制點或選取改變後才更新instance buffer
+    if (m_cp_instance_revision != m_track.revision() || m_cp_instance_selected != m_selected_control_point) {
+        // 沒有選中時為-1，不會和任何index相等
+        const size_t selected = m_selected_control_point >= 0 ? static_cast<size_t>(m_selected_control_point) : m_control_points.size();
+        std::vector<ControlPoint_VAO::Instance> instances;
+        instances.reserve(m_control_points.size());
+        for (size_t i = 0; i < m_control_points.size(); ++i) {
+            const ControlPoint& cp = m_control_points[i];
+            instances.push_back({ cp.pos, cp.orient, i == selected ? 1.f : 0.f });
+        }
+        m_control_point_VAO.set_instances(instances);
+
+        m_cp_instance_revision = m_track.revision();
+        m_cp_instance_selected = m_selected_control_point;
+    }
+
     if (transparent) {
         glEnable(GL_BLEND);
         glBlendFunc(GL_ZERO, GL_ONE);
     }
 
-    for (size_t i = 0; i < m_control_points.size(); ++i) {
-        const glm::vec3& pos = m_control_points[i].pos;
-        const glm::vec3& orient = m_control_points[i].orient;
-
-        m_control_point_shader.Use();
-
-        glm::mat4 model_matrix;
-        model_matrix = glm::identity<glm::mat4>();
-        model_matrix = glm::translate(model_matrix, pos);
-        float theta1 = -atan2(orient.z,orient.x);
-        model_matrix = glm::rotate(model_matrix, theta1, glm::vec3(0, 1, 0));
-        float theta2 = -acos(orient.y);
-        model_matrix = glm::rotate(model_matrix, theta2, glm::vec3(0, 0, 1));
-        glUniformMatrix4fv(
-            glGetUniformLocation(m_control_point_shader.Program, "model_matrix"),
-            1,
-            false, // no transpose
-            glm::value_ptr(model_matrix)
-        );
-
-        glUniform1i(glGetUniformLocation(m_control_point_shader.Program, "is_selected"), i == m_selected_control_point);
-
-        m_control_point_VAO.draw();
-
-        glUseProgram(0);
-    }
+    m_control_point_shader.Use();
+    m_control_point_VAO.draw();
+    glUseProgram(0);
 
     glDisable(GL_BLEND);
 }
 
 void TrainSystem::draw_wood_with_shader()
 {
-    m_wood_shader.Use();
-    glUniform1f(glGetUniformLocation(m_wood_shader.Program, "cp_size"), CONTROL_POINT_SIZE);
-    m_wood_cube.bind_to(0);
+    // 軌道改變後才更新支柱的位置
+    if (m_pillar_revision != m_track.revision()) {
+        std::vector<glm::vec3> positions;
+        for (const ControlPoint& cp : m_control_points) {
+            if (cp.pos.y >= -1) positions.push_back(cp.pos);
+        }
 
-    for (int i = 0; i < m_control_points.size(); ++i) {
-        const glm::vec3& cp_pos = m_control_points[i].pos;
-        if (cp_pos.y < -1) continue;
+        // 沿著軌道每隔 Pillar_Interval 再加一根
+        if (m_extra_pillars) {
+            for (float S = Pillar_Interval; S < m_track.length(); S += Pillar_Interval) {
+                const glm::vec3 pos = m_track.point_at(S_to_T(S));
+                if (pos.y >= -1) positions.push_back(pos);
+            }
+        }
 
-        glUniform3fv(glGetUniformLocation(m_wood_shader.Program, "cp_pos"), 1, glm::value_ptr(cp_pos));
-        m_unit_box_VAO.draw();
+        m_pillar_VAO.set_positions(positions);
+        m_pillar_revision = m_track.revision();
+        m_please_update_track_bvh = true;
     }
 
+    m_wood_shader.Use();
+    m_wood_cube.bind_to(0);
+
+    m_pillar_VAO.draw();
 
     m_wood_cube.unbind_from(0);
     glUseProgram(0);
@@ -440,254 +619,66 @@ void TrainSystem::draw_wood_with_shader()
 
 void TrainSystem::draw_line()
 {
-    glColor3ub(0, 0, 0);
-
-    std::vector<Draw::Param_Equation> pos_eq_vec, orient_eq_vec;
-    this->set_equation(pos_eq_vec, orient_eq_vec);
-
-    // 前一個點的資訊
-    glm::vec3 P1, P1L, P1R;
-    glm::vec3 orient1;
-    bool is_P1_initialized = false;
-    // 現在的點的資訊
-    glm::vec3 P2, P2L, P2R;
-    glm::vec3 orient2;
-
-    constexpr float INTERVAL = 0.01f;
-    for (int i = 0; i < m_control_points.size(); ++i) { // for each control point
-        float t = 0.f;
-        while (t <= 1.f) {
-            if (!is_P1_initialized) {
-                P1 = pos_eq_vec[i](t);
-                orient1 = orient_eq_vec[i](t);
-                t += INTERVAL;
-            }
-
-            P2 = pos_eq_vec[i](t);
-            orient2 = orient_eq_vec[i](t);
-
-            glm::vec3 U = P2 - P1; // 方向向量
-            glm::vec3 RIGHT = glm::normalize(glm::cross(U, (orient1 + orient2) / 2.f)); // 向右
-            glm::vec3 unit = CONTROL_POINT_SIZE * RIGHT;
-
-            if (!is_P1_initialized) {
-                P1L = P1 - unit;
-                P1R = P1 + unit;
-            }
-
-            P2L = P2 - unit;
-            P2R = P2 + unit;
-
-            glBegin(GL_LINES);
-            glVertex3fv(glm::value_ptr(P1L));
-            glVertex3fv(glm::value_ptr(P2L));
-
-            glVertex3fv(glm::value_ptr(P1R));
-            glVertex3fv(glm::value_ptr(P2R));
-            glEnd();
-
-            // 前資訊往前移
-            P1 = P2; P1L = P2L; P1R = P2R;
-            orient1 = orient2;
-
-            is_P1_initialized = true;
-            t += INTERVAL;
-        }
+    // 軌道改變後才重建mesh
+    if (m_rail_revision != m_track.revision()) {
+        m_rail_VAO.rebuild(m_track);
+        m_rail_revision = m_track.revision();
+        m_please_update_track_bvh = true;
     }
-}
 
-void TrainSystem::draw_sleeper() const
-{
-    std::vector<Draw::Param_Equation> point_eq_vec;
-    std::vector<Draw::Param_Equation> orient_eq_vec;
-    point_eq_vec.reserve(m_control_points.size());
-    orient_eq_vec.reserve(m_control_points.size());
-
-    // for each control point
-    for (size_t i = 0; i < m_control_points.size(); ++i) {
-        Draw::Param_Equation point_eq, orient_eq;
-        set_equation(i, point_eq, orient_eq);
-        point_eq_vec.push_back(point_eq);
-        orient_eq_vec.push_back(orient_eq); // store their equation
-    }
-
-    bool wrap_back = false; // 是否繞回S=0了，則是用來確保軌道頭尾相連
-    glm::vec3 p1 = point_eq_vec[0](0);
-
-    for (float S2 = Track_Interval; !wrap_back; S2 += Track_Interval) {
-        // 繞回S=0（S大於等於最大值）了
-        if (S2 >= m_Arc_Len_Accum.back().second) {
-            wrap_back = true;
-            S2 = m_Arc_Len_Accum.back().second;
-        }
-
-        float T2 = S_to_T(S2);
-        glm::vec3 p2, orient; {
-            size_t cp_id = static_cast<size_t>(floorf(T2));
-            float t = T2 - cp_id;
-            p2 = point_eq_vec[cp_id](t);
-            orient = orient_eq_vec[cp_id](t - Param_Interval / 2.f);
-        }
-
-        // points
-        glm::vec3 middle = (p1 + p2) * 0.5f;
-        // 方向向量
-        glm::vec3 u = (p2 - p1);
-        float line_len = glm::length(u); // 這一段的長度
-        u = glm::normalize(u);
-
-        // u 和 orient 外積，得到軌道水平平移（向右）的方向
-        glm::vec3 horizontal = glm::normalize(glm::cross(u, orient));
-
-        // 畫sleeper
-        glm::vec3 DOWN = glm::normalize(glm::cross(u, horizontal));
-        GLfloat rotate_mat[16] = {
-            horizontal.x, horizontal.y, horizontal.z, 0,
-            DOWN.x, DOWN.y, DOWN.z, 0,
-            u.x, u.y, u.z, 0,
-            0, 0, 0, 1
-        };
-        middle = middle + DOWN * CONTROL_POINT_SIZE * 0.05f; // 住下一點點
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glTranslatef(middle.x, middle.y, middle.z);
-        glMultMatrixf(rotate_mat);
-        glScalef(CONTROL_POINT_SIZE * 1.3f, CONTROL_POINT_SIZE * 0.1f, line_len * 0.3f);
-        glColor3ub(255, 255, 255);
-        glEnable(GL_NORMALIZE);
-        {
-            constexpr GLfloat vertex_arr[] = {
-                1, 0, 1,
-                1, 0, -1,
-                -1, 0, -1,
-                -1, 0, 1,
-                1, 1 * 2, 1,
-                1, 1 * 2, -1,
-                -1, 1 * 2, -1,
-                -1, 1 * 2, 1,
-            };
-            constexpr GLuint indices[] = {
-                0, 1, 2, 3, // normal = (0, -1, 0)
-                0, 1, 5, 4, // normal = (1, 0, 0)
-                0, 3, 7, 4, // normal = (0, 0, 1)
-                4, 5, 6, 7, // normal = (0, 1, 0)
-                1, 5, 6, 2, // normal = (0, 0, -1)
-                3, 2, 6, 7  // normal = (-1, 0, 0)
-            };
-
-            glEnableClientState(GL_VERTEX_ARRAY);
-            glVertexPointer(3, GL_FLOAT, 0, vertex_arr);
-
-            glNormal3f(0, -1, 0);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices);
-
-            glNormal3f(1, 0, 0);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices + 4);
-
-            glNormal3f(0, 0, 1);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices + 8);
-
-            glNormal3f(0, 1, 0);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices + 12);
-
-            glNormal3f(0, 0, -1);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices + 16);
-
-            glNormal3f(-1, 0, 0);
-            glDrawElements(GL_QUADS, 4, GL_UNSIGNED_INT, indices + 20);
-
-            glVertexPointer(3, GL_FLOAT, 0, nullptr);
-            glDisableClientState(GL_VERTEX_ARRAY);
-        }
-        glDisable(GL_NORMALIZE);
-        glPopMatrix();
-
-        // store for next iteration
-        p1 = p2;
-    }
+    m_rail_shader.Use();
+    m_rail_VAO.draw();
+    glUseProgram(0);
 }
 
-void TrainSystem::draw_train_with_shader()
+void TrainSystem::draw_sleeper()
 {
-    m_train_shader.Use();
-    glUniform1f(glGetUniformLocation(m_train_shader.Program, "scale"), 1.5f * CONTROL_POINT_SIZE);
-
-    float S = T_to_S(m_trainU);
-
-    for (int i = 0; i <= m_cart_num; ++i) { // i=0 -> 畫車頭； i>0 -> 畫車廂
-        glUniform1i(glGetUniformLocation(m_train_shader.Program, "index"), i);
-
-        float U = S_to_T(S); // 整個參數空間的位置
-        int cp_id = floor(U);
-        float T = U - cp_id; // 兩control point間 參數空間的位置
-
-        Draw::Param_Equation point_eq, orient_eq;
-        this->set_equation(cp_id, point_eq, orient_eq);
-
-        // 位置
-        glm::vec3 pos = point_eq(T);
-        glUniform3fv(glGetUniformLocation(m_train_shader.Program, "translate"), 1, glm::value_ptr(pos));
-
-        // 計算面向的方向
-        glm::vec3 FRONT = glm::normalize(point_eq(T + 0.001) - point_eq(T));
-        glm::vec3 LEFT = glm::normalize(glm::cross(orient_eq(T), FRONT));
-        glm::vec3 TOP = glm::normalize(glm::cross(FRONT, LEFT));
-        glUniform3fv(glGetUniformLocation(m_train_shader.Program, "FRONT"), 1, glm::value_ptr(FRONT));
-        glUniform3fv(glGetUniformLocation(m_train_shader.Program, "LEFT"), 1, glm::value_ptr(LEFT));
-        glUniform3fv(glGetUniformLocation(m_train_shader.Program, "TOP"), 1, glm::value_ptr(TOP));
-
-        if (i == 0)
-            m_train_models[m_which_train].draw();
-        else
-            m_cart_models[m_which_train].draw();
-
-        S -= 5 * CONTROL_POINT_SIZE;
-
-        if (i == 0 && m_smoke_counter == 0) m_smoke_obj.add(pos + (4.1f * CONTROL_POINT_SIZE) * TOP, 25);
+    // 軌道改變後才重算每個枕木的model matrix
+    if (m_sleeper_revision != m_track.revision()) {
+        m_sleeper_VAO.rebuild(m_frames);
+        m_sleeper_revision = m_track.revision();
+        m_please_update_track_bvh = true;
     }
 
+    m_sleeper_shader.Use();
+    m_sleeper_VAO.draw();
     glUseProgram(0);
 }
 
-void TrainSystem::set_equation(std::vector<Draw::Param_Equation> &pos_eqs, std::vector<Draw::Param_Equation> &orient_eqs) const
+size_t TrainSystem::update_cart_frames(size_t k)
 {
-    pos_eqs.clear();
-    orient_eqs.clear();
-
-    for (int i = 0; i < m_control_points.size(); ++i) {
-        Draw::Param_Equation pos_eq, orient_eq;
-
-        this->set_equation(i, pos_eq, orient_eq);
-
-        pos_eqs.push_back(pos_eq);
-        orient_eqs.push_back(orient_eq);
-    }
+    // 一次求出這列火車每節車廂的位置及面向的方向
+    const size_t num = static_cast<size_t>(m_render_fleet.cart_num(k)) + 1;
+    for (size_t i = m_cart_offsets.size(); i < num; ++i)
+        m_cart_offsets.push_back(i * m_render_fleet.cart_spacing());
+    m_cart_frames.resize(std::max(m_cart_frames.size(), num));
+    m_frames.at_chain(this->render_S(k), m_cart_offsets.data(), num, m_cart_frames.data());
+    return num;
 }
 
-void TrainSystem::set_equation(int cp_id, Draw::Param_Equation &pos_eq, Draw::Param_Equation &orient_eq) const
+void TrainSystem::draw_train_with_shader()
 {
-    if (m_line_type == SplineType::LINEAR) {
-        const ControlPoint& CP = m_control_points[cp_id];
-        const ControlPoint& nCP = m_control_points[next_CP(cp_id)];
+    m_train_shader.Use();
 
-        pos_eq = Draw::make_line(CP.pos, nCP.pos);
-        orient_eq = Draw::make_line(CP.orient, nCP.orient);
-    }
-    else {
-        const ControlPoint& pCP = m_control_points[prev_CP(cp_id)];
-        const ControlPoint& CP = m_control_points[cp_id];
-        const ControlPoint& nCP = m_control_points[next_CP(cp_id)];
-        const ControlPoint& nnCP = m_control_points[next_CP(next_CP(cp_id))];
-
-        if (m_line_type == SplineType::CARDINAL) {
-            pos_eq = Draw::make_cardinal(pCP.pos, CP.pos, nCP.pos, nnCP.pos, m_cardinal_tension);
-            orient_eq = Draw::make_cardinal(pCP.orient, CP.orient, nCP.orient, nnCP.orient, m_cardinal_tension);
-        }
-        else {
-            pos_eq = Draw::make_cubic_b_spline(pCP.pos, CP.pos, nCP.pos, nnCP.pos);
-            orient_eq = Draw::make_cubic_b_spline(pCP.orient, CP.orient, nCP.orient, nnCP.orient);
+    for (size_t k = 0; k < m_render_fleet.size(); ++k) {
+        const size_t num = this->update_cart_frames(k);
+        for (size_t i = 0; i < num; ++i) { // i=0 -> 畫車頭； i>0 -> 畫車廂
+            m_train_uniforms.index.set(static_cast<int>(i));
+
+            const FrameTable::Frame& f = m_cart_frames[i];
+            m_train_uniforms.translate.set(f.pos);
+            m_train_uniforms.FRONT.set(f.FRONT);
+            m_train_uniforms.LEFT.set(f.LEFT);
+            m_train_uniforms.TOP.set(f.TOP);
+
+            if (i == 0)
+                m_train_models[m_which_train].draw();
+            else
+                m_cart_models[m_which_train].draw();
         }
     }
+
+    glUseProgram(0);
 }
 
 
@@ -5,27 +5,22 @@
 #include <glm/vec3.hpp>
 #include <vector>
 #include <utility>
+#include <memory>
 #include <QObject>
 #include <qtTextureCubeMap.h>
-#include <Box_VAO.h>
 #include <Shader.h>
 #include <Model.h>
-#include "ParamEquation.h"
+#include "TrackCurve.h"
+#include "FrameTable.h"
 #include "ControlPoint_VAO.h"
-#include "Particle.h"
-
-/// 控制點
-struct ControlPoint {
-    glm::vec3 pos;
-    glm::vec3 orient;
-};
-
-/// 火車用的軌道樣式
-enum class SplineType {
-    LINEAR,   ///< 直線
-    CARDINAL, ///< cardinal
-    CUBIC_B   ///< cubic B spline
-};
+#include "ControlPointGrid.h"
+#include "RayCast.h"
+#include "Pillar_VAO.h"
+#include "Rail_VAO.h"
+#include "Sleeper_VAO.h"
+#include "TrainFleet.h"
+#include "TrainSimulation.h"
+#include "GPUParticle.h"
 
 /// 火車
 class TrainSystem : public QObject
@@ -40,49 +35,81 @@ private:
                                                   : (old - 1) % m_control_points.size()); }
 
     /// 若沒有選中控制點，回傳true；否則回傳false
-    bool nothing_is_selected() const { return m_selected_control_point < 0 || m_selected_control_point >= m_control_points.size(); }
+    bool nothing_is_selected() const { return m_selected_control_point < 0 || static_cast<size_t>(m_selected_control_point) >= m_control_points.size(); }
 
 private:
     /// @name Arc Length Accumulation
     /// @{
 
-    /// @brief 曲線長累積表的型別
-    /// @details Accumulation of arc length. elem.first = t in "param space", elem.second = s in "real space"
-    typedef std::vector< std::pair< float, float > >  Arc_Len_Accum_T ;
-
     /// @brief 將參數空間中的T 換成 實際距離S
-    /// @details 依據 this->Arc_Len_Accum 做轉換
-    float  T_to_S (float T) const;
+    /// @details 依據 m_track 的曲線長累積表做轉換，O(1)
+    float  T_to_S (float T) const { return m_track.T_to_S(T); }
 
     /// @brief 將實際距離S 換成 參數空間中的T
-    /// @details 依據 this->Arc_Len_Accum 做轉換
-    float  S_to_T (float S) const;
+    /// @details 依據 m_track 的曲線長累積表做轉換，O(1)
+    float  S_to_T (float S) const { return m_track.S_to_T(S); }
 
-    /// 更新 m_Arc_Len_Accum
+    /// 重建 m_track（每段曲線的參數式及曲線長累積表）
     /// @post `m_please_update_arc_len_accum = false;`
     void update_arc_len_accum();
 
+    /// 軌道改變後重建 m_frames，物理模式下也重建速度表（每次改變只重建一次）
+    void update_frames();
+
+    /// 依照 m_frames 重建速度表，並交給 m_sim
+    void update_velocity_profile();
+
     /// @}
 
 public:
     /// @name Edit
     /// @brief 下列function都可能會改變Arc Len Accum
+    /// @details 拖移、設定orient、新增、刪除控制點時，只會重算那個控制點附近的曲線（見 TrackCurve::update_control_point()）；
+    ///          其他的修改會等到下次 draw() 時才整個重建
     /// @{
 
     /// @brief 處理點擊，並選擇控制點
+    /// @details 點在控制點的box上（包含邊界）就會選到，和 ray_cast() 打到控制點的範圍相同
     /// @param pos - 世界座標
     /// @return 是否處理點擊事件
     /// @post emit is_point_selected()
     bool process_click(glm::vec3 pos);
 
+    /**
+     * @brief 射線和控制點、鐵軌、枕木、支柱及火車最近的交點
+     * @details
+     * 每個控制點以包住它的軸對齊box近似，每節車廂以它的模型在車廂座標系中的bounding box近似；
+     * 鐵軌、枕木和支柱用和畫出來相同的三角形，存在 TriangleBVH 中，軌道改變後第一次呼叫時才重建；
+     * 因此只在點擊時呼叫，拖移時不要呼叫。
+     * 火車的位置和上次 draw() 時相同。
+     * @return 交點的 t；沒有打到時回傳 RayCast::No_Hit
+     */
+    float ray_cast(const Ray& ray);
+
+    /**
+     * @brief 框選：位置在 [min, max] 內的所有控制點
+     * @return 控制點的index，由小到大
+     */
+    std::vector<int> control_points_in_box(const glm::vec3& min, const glm::vec3& max) const { return m_cp_grid.query_box(min, max); }
+
+    /**
+     * @brief 離 pos 最近的（最多）n 個控制點
+     * @return 控制點的index，由近到遠
+     */
+    std::vector<int> nearest_control_points(const glm::vec3& pos, size_t n) const { return m_cp_grid.nearest(pos, n); }
+
     /**
      * @brief 處理拖移
+     * @details 只用到 eye 到 pos 的直線，所以 pos 可以是視線上的任一點
      * @param eye - 眼睛的位置
      * @param pos - 點的位置
      * @return 是否處理拖移事件
      */
     bool process_drag(glm::vec3 eye, glm::vec3 pos);
 
+    /// 是否有選中的控制點（有的話，拖移會交給 process_drag() 處理）
+    bool has_selected_control_point() const { return !nothing_is_selected(); }
+
     /**
      * @brief 新增一個control point
      * @post 看原本有沒有控制點被選中，並emit is_point_selected()
@@ -131,15 +158,22 @@ public:
      */
     void set_tension(float tension) { m_cardinal_tension = tension; m_please_update_arc_len_accum = true; }
 
+    /**
+     * @brief 設定建立曲線長累積表時可接受的誤差
+     * @param tolerance - 每段曲線可接受的誤差（實際距離），越小取樣越多
+     */
+    void set_arc_len_tolerance(float tolerance) { m_arc_len_tolerance = tolerance; m_please_update_arc_len_accum = true; }
+
     /**
      * @brief 匯入控制點
+     * @details 依檔案內容判斷是二進位格式還是文字格式，見 TrackIO
      * @param path - 檔案路徑
      */
     void import_control_points(std::string path);
 
     /**
      * @brief 匯出控制點
-     * @param path - 檔案路徑
+     * @param path - 檔案路徑，副檔名為 .trk 時寫成二進位格式（含曲線長累積表），否則寫成文字格式
      */
     void export_control_points(std::string path) const;
 
@@ -148,9 +182,26 @@ public:
 public:
     TrainSystem();
 
-    /// @brief 依據trainU和ArcLenAccum去更新並往前火車的位置
-    /// @param distance - 向前的距離
-    void updateTrainPos(float distance);
+    /// @brief 從模擬取得最新的火車狀態，並更新主火車的位置
+    /// @details
+    /// 火車由 simulation() 以固定的時間間隔推進，這裡只複製最新的狀態，
+    /// 並依照距離上一步經過的時間在兩步間內插。上次同步後模擬的每一步各更新一次輪子的模型和smoke。
+    void sync_trains();
+
+    /// 以固定時間間隔推進的火車模擬（可開thread，或由呼叫者推進時間）
+    TrainSimulation& simulation() { return m_sim; }
+
+    /// 設定速度倍率為1的火車每一步（TrainSimulation::step_seconds() 秒）前進多遠
+    void set_train_speed(float distance_per_step) { m_sim.set_distance_per_step(distance_per_step); }
+
+    /**
+     * @brief 開關「物理模式」
+     * @param on - true->依軌道高度預先算好的速度表前進（含摩擦、lift及煞車）；false->以 set_train_speed() 的速度前進
+     */
+    void toggle_physics(bool on);
+
+    /// 物理模式下繞軌道一圈要多久（秒），不是物理模式時為0
+    float get_lap_time() const { return m_velocity_profile ? m_velocity_profile->lap_time() : 0.f; }
 
     /// 取得火車的位置
     glm::vec3 getTrainPos() const { return m_train_pos; }
@@ -164,85 +215,132 @@ public:
     /// 取得控制點的個數
     int get_cp_num() const { return m_control_points.size(); }
 
-    /// 增加一個車廂
-    void add_cart() { ++m_cart_num; }
-    /// 刪除一個車廂
-    void delete_cart() { m_cart_num = (m_cart_num > 0 ? m_cart_num - 1 : 0); }
-    /// 清除全部車廂
-    void clear_cart() { m_cart_num = 0; }
+    /// 取得建立曲線長累積表時，每段曲線各用了幾個取樣點
+    const std::vector<int>& get_arc_len_samples() const { return m_track.arc_len_accum().segment_samples(); }
+
+    /// 主火車增加一個車廂
+    void add_cart();
+    /// 主火車刪除一個車廂
+    void delete_cart();
+    /// 主火車清除全部車廂
+    void clear_cart();
+
+    /// 在軌道上最大的空隙放一列新的火車（車廂數量和主火車相同）
+    void add_train();
+    /// 刪除最後加入的火車（主火車不會被刪除）
+    void delete_train();
+    /// 軌道上有幾列火車（含主火車）
+    size_t get_train_num() const { return m_render_fleet.size(); }
+
+    /**
+     * @brief 開關「額外的支柱」
+     * @param on - true->除了控制點下方，也沿著軌道每隔一段距離加一根支柱；false->只有控制點下方有支柱
+     */
+    void toggle_extra_pillars(bool on) { m_extra_pillars = on; m_pillar_revision = static_cast<size_t>(-1); }
 
     /// 畫出來
     /// @param wireframe - 是否是wireframe
     void draw(bool wireframe);
 
 private:
-    /// 畫控制點
+    /// 畫控制點（控制點或選取改變時才更新instance buffer）
     void draw_control_points_with_shader(bool transparent);
 
-    /// 畫出木頭支柱
+    /// 畫出木頭支柱（軌道改變時才更新instance buffer）
     void draw_wood_with_shader();
 
-    /// 畫出軌道的線
+    /// 畫出鐵軌（軌道改變時才重建mesh）
     void draw_line();
 
-    /// 畫枕木
-    void draw_sleeper() const;
+    /// 畫枕木（軌道改變時才重算每個枕木的位置）
+    void draw_sleeper();
 
     /// 畫火車
     void draw_train_with_shader();
 
-    /**
-     * @brief 設置好「每兩個」控制點間的參數式
-     * @param[out] pos_eqs - 第i項為 i 和 i+1 間座標的參數式
-     * @param[out] orient_eqs - 第i項為 i 和 i+1 間orient的參數式
-     * @post pos_eqs 和 orient_eqs 會先清空，再填值
-     */
-    void set_equation(std::vector<Draw::Param_Equation>& pos_eqs, std::vector<Draw::Param_Equation>& orient_eqs) const;
+    /// 第i列火車在這次繪製時的位置（在模擬的上一步和這一步間內插）
+    float render_S(size_t i) const { return m_render_fleet.S(i) - (1.f - m_render_alpha) * m_render_fleet.moved(i); }
 
-    /**
-     * @brief 設定兩控制點間的參數式
-     * @param cp_id - 控制點id
-     * @param[out] pos_eq - 點的參數式
-     * @param[out] orient_eq - orient的參數式
-     */
-    void set_equation(int cp_id, Draw::Param_Equation& pos_eq, Draw::Param_Equation &orient_eq) const;
+    /// 一次求出第k列火車每節車廂的座標系，放在 m_cart_frames 的前面；回傳車廂的數量（含車頭）
+    size_t update_cart_frames(size_t k);
 
 signals:
     /// 當有control point 被選中 or 被取消選取都會emit
     /// @param select - true->有被選中；false->沒被選中
     void is_point_selected(bool select);
 
+    /// 物理模式的速度表重建或物理模式關閉時emit
+    /// @param seconds - 繞軌道一圈要多久，不是物理模式時為0（同 get_lap_time()）
+    void lap_time_changed(float seconds);
+
 
 private:
     std::vector<ControlPoint> m_control_points; ///< 所有控制點
     int m_selected_control_point;  ///< 選中的控制點
     ControlPoint_VAO m_control_point_VAO; ///< 控制點的VAO
     Shader m_control_point_shader;   ///< 控制點的shader
+    size_t m_cp_instance_revision;   ///< m_control_point_VAO 的instance buffer是依照哪個 TrackCurve::revision() 建的
+    int m_cp_instance_selected;      ///< m_control_point_VAO 的instance buffer中被選中的控制點
+    ControlPointGrid m_cp_grid;      ///< 控制點的空間索引，控制點改變時同時更新
 
     SplineType m_line_type; ///< 線的型式
     float m_cardinal_tension;  ///< tension for cardinal spline
 
-    TrainSystem::Arc_Len_Accum_T m_Arc_Len_Accum; ///< Accumulation of arc length. elem.first = t in "param space", elem.second = s in "real space".
+    TrackCurve m_track; ///< 每段曲線的參數式及曲線長累積表，只在 m_please_update_arc_len_accum 時整個重建
+    float m_arc_len_tolerance; ///< 建立曲線長累積表時，每段曲線可接受的誤差
+
+    FrameTable m_frames;     ///< 沿著軌道的座標系表，火車、枕木和追蹤的鏡頭都用它
+    size_t m_frame_revision; ///< m_frames 是依照哪個 TrackCurve::revision() 建的
+    std::shared_ptr<const VelocityProfile> m_velocity_profile; ///< 物理模式下的速度表，不是物理模式時為nullptr
+
+    Rail_VAO m_rail_VAO;    ///< 鐵軌的mesh
+    Shader m_rail_shader;   ///< 繪製鐵軌的shader
+    size_t m_rail_revision; ///< m_rail_VAO 是依照哪個 TrackCurve::revision() 建的
+
+    Sleeper_VAO m_sleeper_VAO;    ///< 所有枕木
+    Shader m_sleeper_shader;      ///< 繪製枕木的shader
+    size_t m_sleeper_revision;    ///< m_sleeper_VAO 是依照哪個 TrackCurve::revision() 建的
 
     Shader m_wood_shader;  ///< 繪製木頭支柱
     qtTextureCubeMap m_wood_cube; ///< 木頭的材質，綁定在0
 
-    Box_VAO m_unit_box_VAO; ///< 表示方塊的VAO
+    Pillar_VAO m_pillar_VAO;  ///< 所有木頭支柱
+    bool m_extra_pillars;     ///< 是否沿著軌道加上額外的支柱
+    size_t m_pillar_revision; ///< m_pillar_VAO 是依照哪個 TrackCurve::revision() 建的
+
+    TriangleBVH m_track_bvh;         ///< 鐵軌、枕木和支柱的三角形，給 ray_cast() 用
+    bool m_please_update_track_bvh;  ///< 若為true，則在下次 ray_cast() 時重建 m_track_bvh
 
-    glm::vec3 m_train_pos; ///!< 火車在哪
-    float m_trainU; ///< 火車在參數空間的哪裡
+    glm::vec3 m_train_pos; ///!< 主火車在哪
+    TrainSimulation m_sim;      ///< 軌道上所有火車的模擬，編號為 Main_Train_ID 的是主火車
+    TrainFleet m_render_fleet;  ///< 上次 sync_trains() 時從 m_sim 複製的狀態，繪圖時只用它
+    float m_render_alpha;       ///< 上次 sync_trains() 時，距離模擬的最新一步經過了幾分之幾步
+    size_t m_synced_step;       ///< 上次 sync_trains() 時，模擬總共前進了幾步
+    std::vector<float> m_cart_offsets;            ///< 第i項為第i節車廂（0為車頭）和車頭的距離，繪圖時重複使用
+    std::vector<FrameTable::Frame> m_cart_frames; ///< 一列火車每節車廂的座標系，繪圖時重複使用
     Model m_train_models[6]; ///< 火車模型
     Model m_cart_models[6];  ///< 車廂模型
+    glm::vec3 m_train_min, m_train_max; ///< 所有火車模型合起來的bounding box（模型座標），給 ray_cast() 用
+    glm::vec3 m_cart_min, m_cart_max;   ///< 所有車廂模型合起來的bounding box（模型座標），給 ray_cast() 用
     int m_which_train; ///< 6種火車模型，每一個的輪子都轉動不同的角度，連續切換可形成轉動的效果
-    int m_cart_num; ///< 車廂數量
 
-    Particle m_smoke_obj; ///< smoke
+    GPUParticle m_particles; ///< 所有粒子特效，在GPU上模擬、一次畫完
+    size_t m_smoke_emitter;     ///< 主火車的煙的發射點
+    size_t m_steam_emitter;     ///< 主火車的蒸氣的發射點（在CPU上模擬）
     int m_smoke_counter; ///< counter歸零才加smoke
 
     Shader m_train_shader;  ///< 繪製火車的shader
+    /// m_train_shader 中每畫一節車廂都要更新的uniform
+    struct {
+        Shader::Uniform<GLint> index;
+        Shader::Uniform<glm::vec3> translate;
+        Shader::Uniform<glm::vec3> FRONT;
+        Shader::Uniform<glm::vec3> LEFT;
+        Shader::Uniform<glm::vec3> TOP;
+    } m_train_uniforms;
 
     bool m_is_vertical_move; ///< 是否鉛直移動 control point
-    bool m_please_update_arc_len_accum; ///< 若為true，則在 TrainSystem::draw() 時會呼叫 TrainSystem::update_arc_len_accum
+    bool m_please_update_arc_len_accum; ///< 若為true，則在 TrainSystem::draw() 時會呼叫 TrainSystem::update_arc_len_accum 重建 m_track
 };
 
 #endif // TRAINSYSTEM_H
@@ -0,0 +1,69 @@
+#include "VelocityProfile.h"
+#include <cmath>
+#include <algorithm>
+
+/// @brief 最多繞幾圈來讓起點的速度收斂
+/// @details 每繞一圈的結果對起點的速度是單調的，碰到lift或煞車後就和起點無關，通常兩三圈就收斂；
+///          一直沒碰到時每圈都因摩擦變慢，也會在速度降到lift後收斂
+constexpr int Max_Laps = 64;
+
+VelocityProfile::VelocityProfile(float interval, float gravity, float friction, float lift_speed, float max_speed)
+    : m_speed(), m_interval(interval), m_step(0.f), m_length(0.f), m_lap_time(0.f),
+    m_gravity(gravity), m_friction(friction), m_lift_speed(lift_speed), m_max_speed(max_speed)
+{
+}
+
+void VelocityProfile::rebuild(const FrameTable &frames)
+{
+    m_length = frames.length();
+    const size_t N = std::max<size_t>(1, static_cast<size_t>(std::ceil(m_length / m_interval)));
+    m_step = m_length / N;
+
+    std::vector<float> height(N + 1);
+    for (size_t k = 0; k <= N; ++k)
+        height[k] = frames.at(k * m_step).pos.y;
+
+    const float min_v2 = m_lift_speed * m_lift_speed;
+    const float max_v2 = m_max_speed * m_max_speed;
+    const float friction_loss = 2.f * m_friction * m_gravity * m_step; // 每一段因摩擦而減少的 v^2
+
+    // 從S=0以最低速度出發，繞到起點的速度不再改變為止
+    std::vector<float> v2s(N + 1);
+    v2s[0] = min_v2;
+    for (int lap = 0; lap < Max_Laps; ++lap) {
+        for (size_t k = 0; k < N; ++k) {
+            const float v2 = v2s[k] - 2.f * m_gravity * (height[k + 1] - height[k]) - friction_loss;
+            v2s[k + 1] = std::min(std::max(v2, min_v2), max_v2); // lift & brake
+        }
+        if (std::abs(v2s[N] - v2s[0]) <= 1.e-4f * std::max(v2s[0], 1.f) || lap + 1 == Max_Laps)
+            break;
+        v2s[0] = v2s[N];
+    }
+
+    // 還沒完全收斂時，把起點和終點的差沿著S線性分散掉，讓速度在起點連續
+    const float seam = v2s[0] - v2s[N];
+    m_speed.resize(N + 1);
+    for (size_t k = 0; k <= N; ++k) {
+        const float v2 = v2s[k] + seam * (float(k) / N);
+        m_speed[k] = std::sqrt(std::min(std::max(v2, min_v2), max_v2));
+    }
+
+    // 每段用平均速度算經過的時間
+    m_lap_time = 0.f;
+    for (size_t k = 0; k < N; ++k)
+        m_lap_time += m_step / (0.5f * (m_speed[k] + m_speed[k + 1]));
+}
+
+float VelocityProfile::at(float S) const
+{
+    if (m_step <= 0.f)
+        return m_speed.front();
+
+    S = std::fmod(S, m_length);
+    if (S < 0.f)
+        S += m_length;
+
+    const size_t i = std::min(static_cast<size_t>(S / m_step), m_speed.size() - 2);
+    const float f = S / m_step - i;
+    return m_speed[i] + (m_speed[i + 1] - m_speed[i]) * f;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file VelocityProfile.h
+ * @brief 由軌道高度預先算好的速度表
+ */
+#ifndef VELOCITYPROFILE_H
+#define VELOCITYPROFILE_H
+
+#include <vector>
+#include "FrameTable.h"
+
+/**
+ * @brief 以實際距離S等距取樣的速度表
+ * @details
+ * 依能量守恆，沿著軌道由 v^2 = v0^2 - 2g * dh - 2 * friction * g * ds 算出每個位置的速度：
+ * - 速度低於 lift_speed 時，視為鏈條把火車以 lift_speed 拉上去（lift）
+ * - 速度高於 max_speed 時，視為煞車把速度壓在 max_speed（brake）
+ *
+ * 因為軌道是封閉的，會從S=0開始繞幾圈，直到起點的速度不再改變；
+ * 繞到圈數的上限還沒收斂時，把起點和終點的差沿著S線性分散掉，速度在起點仍然連續。
+ * 軌道改變後呼叫一次 rebuild()，之後每一步只需要查表。
+ *
+ * 這個class不會呼叫任何OpenGL或Qt的函式。
+ */
+class VelocityProfile
+{
+private:
+    std::vector<float> m_speed; ///< 第k項為 S = k * m_step 的速度，最後一項和第0項在同一個位置
+    float m_interval;  ///< 取樣間距的上限
+    float m_step;      ///< 實際的取樣間距
+    float m_length;    ///< 軌道的長度
+    float m_lap_time;  ///< 繞一圈要多久
+
+    float m_gravity;     ///< 重力加速度
+    float m_friction;    ///< 摩擦係數
+    float m_lift_speed;  ///< lift把火車拉上去的速度，也是最低速度
+    float m_max_speed;   ///< 煞車限制的最高速度
+
+public:
+    /**
+     * @param interval - 取樣間距的上限（實際距離）
+     * @param gravity - 重力加速度（每秒平方的距離）
+     * @param friction - 摩擦係數
+     * @param lift_speed - 最低速度，低於它的地方由lift以這個速度拉上去
+     * @param max_speed - 最高速度，高於它的地方會煞車
+     */
+    VelocityProfile(float interval, float gravity, float friction, float lift_speed, float max_speed);
+
+    /**
+     * @brief 依照座標系表中的高度重建速度表
+     * @param frames - 座標系表，不可為空
+     */
+    void rebuild(const FrameTable& frames);
+
+    /// 是否還沒建立
+    bool empty() const { return m_speed.empty(); }
+
+    /**
+     * @brief 實際距離S處的速度（每秒的距離）
+     * @param S - 可以是任何值，會先wrap回 [0, 軌道長度)
+     * @pre !empty()
+     */
+    float at(float S) const;
+
+    /// 繞一圈要多久（秒）
+    float lap_time() const { return m_lap_time; }
+};
+
+#endif // VELOCITYPROFILE_H
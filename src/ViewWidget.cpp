@@ -8,6 +8,15 @@
 #include <QMouseEvent>
 #include <QWheelEvent>
 #include <QFileDialog>
+#include <algorithm>
+#include <cstring>
+
+/// 水面在 y = WATER_HEIGHT
+constexpr float WATER_HEIGHT = -0.3f;
+/// 光源的位置
+const glm::vec4 LIGHT_POSITION(0, 5, 10, 1);
+/// 每個frame有幾個pass（反射、折射、最終畫面）
+constexpr int PASS_NUM = 3;
 
 void GLAPIENTRY
 MessageCallback( GLenum source,
@@ -43,29 +52,63 @@ ViewWidget::~ViewWidget()
 void ViewWidget::update_view_from_arc_ball()
 {
     glm::mat4 view_matrix = m_arc_ball.view_matrix();
-    m_matrices_UBO_p->BufferSubData(0, sizeof(glm::mat4), glm::value_ptr(view_matrix));
     glMatrixMode(GL_MODELVIEW);
     glLoadMatrixf(glm::value_ptr(view_matrix));
+}
+
+void ViewWidget::bind_pass_uniforms(const float clip[4])
+{
+    const glm::mat4 matrices[2] = { m_arc_ball.view_matrix(), m_proj_matrix };
+    const glm::vec4 light[2] = { glm::vec4(m_arc_ball.calc_pos(), 1), LIGHT_POSITION };
 
-    m_light_UBO_p->BufferSubData(0, sizeof(glm::vec4), glm::value_ptr(m_arc_ball.calc_pos()));
+    StreamBuffer::Allocation a = m_pass_uniforms_p->allocate(sizeof(matrices), m_UBO_alignment);
+    std::memcpy(a.ptr, matrices, sizeof(matrices));
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, m_pass_uniforms_p->name(), a.offset, sizeof(matrices));
+
+    a = m_pass_uniforms_p->allocate(sizeof(light), m_UBO_alignment);
+    std::memcpy(a.ptr, light, sizeof(light));
+    glBindBufferRange(GL_UNIFORM_BUFFER, 1, m_pass_uniforms_p->name(), a.offset, sizeof(light));
+
+    a = m_pass_uniforms_p->allocate(sizeof(glm::vec4), m_UBO_alignment);
+    std::memcpy(a.ptr, clip, sizeof(glm::vec4));
+    glBindBufferRange(GL_UNIFORM_BUFFER, 3, m_pass_uniforms_p->name(), a.offset, sizeof(glm::vec4));
 }
 
 void ViewWidget::process_click_for_obj(QPoint winPos, bool is_drag)
 {
     // Qt的y是從上往下算，OpenGL是從下往上算
-    glm::vec3 winPos3D(winPos.x(), this->height() - winPos.y(), 0);
-    glReadPixels(winPos3D.x, winPos3D.y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &winPos3D.z);
+    const float win_x = winPos.x(), win_y = this->height() - winPos.y();
 
     glm::mat4 view_matrix = m_arc_ball.view_matrix();
     glm::vec4 viewport(0, 0, this->width(), this->height());
-    // 計算點在世界座標的哪裡
-    glm::vec3 pos = glm::unProject(winPos3D, view_matrix, m_proj_matrix, viewport);
+    // 從near plane射向far plane的射線，t = 1 時在far plane上
+    const glm::vec3 near_pos = glm::unProject(glm::vec3(win_x, win_y, 0), view_matrix, m_proj_matrix, viewport);
+    const glm::vec3 far_pos = glm::unProject(glm::vec3(win_x, win_y, 1), view_matrix, m_proj_matrix, viewport);
+    const Ray ray{ near_pos, far_pos - near_pos };
 
     if (is_drag) {
+        // 拖移控制點只需要視線上的一點，取far plane上的點即可；
+        // 否則只有水會處理拖移，只需要和島及水面相交。
+        // 兩者都不和鐵軌、火車相交，拖移時才不會每次移動都重建 TrainSystem 的BVH
+        float t = 1;
+        if (!m_train_obj_p->has_selected_control_point())
+            t = std::min({ 1.f, m_island_obj_p->ray_cast(ray), RayCast::plane_y(ray, WATER_HEIGHT) });
+        const glm::vec3 pos = ray.origin + t * ray.dir;
+
         m_train_obj_p->process_drag(m_arc_ball.calc_pos(), pos) ||
             m_water_obj_p->process_click(pos);
     }
     else {
+        // 在CPU上找最近的交點，不需要讀回depth buffer（不用等GPU畫完）
+        float t = std::min({ m_train_obj_p->ray_cast(ray),
+                             m_island_obj_p->ray_cast(ray),
+                             RayCast::plane_y(ray, WATER_HEIGHT) });
+        // 什麼都沒打到時和背景的深度一樣，取far plane上的點
+        if (t > 1)
+            t = 1;
+        // 計算點在世界座標的哪裡
+        const glm::vec3 pos = ray.origin + t * ray.dir;
+
         std::cout << "Clicked on (" << pos.x << ", " << pos.y << ", " << pos.z << ')' << std::endl;
 
         m_train_obj_p->process_click(pos) ||
@@ -85,20 +128,20 @@ void ViewWidget::initializeGL()
     std::cerr << "Load OpenGL" << GLAD_VERSION_MAJOR(version) << '.' << GLAD_VERSION_MINOR(version) << '\n';
 
     /// @todo load UBO
-    m_matrices_UBO_p = std::make_unique<UBO>(2 * sizeof(glm::mat4), GL_DYNAMIC_DRAW);
-    //
-    m_light_UBO_p = std::make_unique<UBO>(2 * sizeof(glm::vec4), GL_DYNAMIC_DRAW);
-    m_light_UBO_p->BufferSubData(sizeof(glm::vec4), sizeof(glm::vec4), glm::value_ptr(glm::vec4(0, 5, 10, 1)));
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_UBO_alignment);
     this->update_view_from_arc_ball();
     //
     m_cel_shading_p = std::make_unique<UBO>(2 * sizeof(int), GL_STATIC_DRAW);
     int cel_option[2] = { 0, 4 };
     m_cel_shading_p->BufferData(cel_option);
-    //
-    m_clip_UBO_p = std::make_unique<UBO>(sizeof(glm::vec4), GL_DYNAMIC_DRAW);
 
     /// @todo initialize drawable object
     try {
+        // 一個區域放一個frame所有pass的 Matrices、Light、Clip（各自對齊）
+        auto align = [this](GLsizeiptr size) { return (size + m_UBO_alignment - 1) / m_UBO_alignment * m_UBO_alignment; };
+        const GLsizeiptr pass_size = align(2 * sizeof(glm::mat4)) + align(2 * sizeof(glm::vec4)) + align(sizeof(glm::vec4));
+        m_pass_uniforms_p = std::make_unique<StreamBuffer>(PASS_NUM * pass_size);
+
         m_skybox_obj_p = std::make_unique<Skybox>();
         m_water_obj_p = std::make_unique<Water>();
         m_reflection_FBO_p = std::make_unique<FBO>(width(), height());
@@ -106,6 +149,10 @@ void ViewWidget::initializeGL()
 
         m_train_obj_p = std::make_unique<TrainSystem>();
         connect(m_train_obj_p.get(), &TrainSystem::is_point_selected, this, &ViewWidget::is_point_selected);
+        connect(m_train_obj_p.get(), &TrainSystem::lap_time_changed, this, &ViewWidget::lap_time_changed);
+        // 火車在另一個thread以固定的時間間隔模擬，不受繪製的速度影響
+        m_train_obj_p->set_train_speed(m_train_speed);
+        m_train_obj_p->simulation().start();
 
         m_island_obj_p = std::make_unique<Island>();
 
@@ -153,7 +200,6 @@ void ViewWidget::resizeGL(int w, int h)
 {
     // update projection matrix
     m_proj_matrix = glm::perspective<float>(glm::radians(50.f), (float)w / h, 0.1f, 200.f);
-    m_matrices_UBO_p->BufferSubData(sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(m_proj_matrix));
     glMatrixMode(GL_PROJECTION);
     glLoadMatrixf(glm::value_ptr(m_proj_matrix));
 
@@ -165,22 +211,18 @@ void ViewWidget::resizeGL(int w, int h)
 
 void ViewWidget::paintGL()
 {
-    constexpr float WATER_HEIGHT = -0.3f;
     constexpr float  NO_CLIP[4]   = {0, 0, 0, 0}, ABOVE_WATER[4]   = {0, 1, 0, -WATER_HEIGHT}, UNDER_WATER[4]   = {0, -1, 0, WATER_HEIGHT};
     constexpr double NO_CLIP_D[4] = {0, 0, 0, 0}, ABOVE_WATER_D[4] = {0, 1, 0, -WATER_HEIGHT}, UNDER_WATER_D[4] = {0, -1, 0, WATER_HEIGHT};
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    m_train_obj_p->updateTrainPos(m_train_speed);
+    m_train_obj_p->sync_trains();
 
     if (m_tracking_train) {
         m_arc_ball.set_center(m_train_obj_p->getTrainPos());
         this->update_view_from_arc_ball();
     }
 
-    // bind UBO
-    m_matrices_UBO_p->bind_to(0);
-    m_light_UBO_p->bind_to(1);
+    // bind UBO（binding 0、1、3 由 bind_pass_uniforms() 綁定）
     m_cel_shading_p->bind_to(2);
-    m_clip_UBO_p->bind_to(3);
 
     int old_FBO;
     glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &old_FBO);
@@ -195,7 +237,7 @@ void ViewWidget::paintGL()
     this->update_view_from_arc_ball();
     // draw
     glClipPlane(GL_CLIP_PLANE0, ABOVE_WATER_D);       // glClipPlane會將這平面轉成視空間的座標，所以要改完ModelView Matrix才能設定
-    m_clip_UBO_p->BufferData((void*)ABOVE_WATER);
+    this->bind_pass_uniforms(ABOVE_WATER);
     this->drawStuffs_without_water();
     // 復原相機
     m_arc_ball.set_center(m_arc_ball.center() + delta);
@@ -206,13 +248,13 @@ void ViewWidget::paintGL()
     m_refraction_FBO_p->bind_FBO_and_set_viewport(GL_DRAW_FRAMEBUFFER);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glClipPlane(GL_CLIP_PLANE0, UNDER_WATER_D);
-    m_clip_UBO_p->BufferData((void*)UNDER_WATER);
+    this->bind_pass_uniforms(UNDER_WATER);
     this->drawStuffs_without_water();
 
     // 繪製最終畫面 + 後處理
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, old_FBO);
     glClipPlane(GL_CLIP_PLANE0, NO_CLIP_D);
-    m_clip_UBO_p->BufferData((void*)NO_CLIP);
+    this->bind_pass_uniforms(NO_CLIP);
     m_post_processor_p->prepare();
     this->drawStuffs_without_water();
     m_water_obj_p->draw(m_wireframe_mode, *m_reflection_FBO_p, *m_refraction_FBO_p);
@@ -344,6 +386,13 @@ void ViewWidget::keyReleaseEvent(QKeyEvent *e)
 
 // Slots //////////////////////////////////////////////////////////////////////////////
 
+void ViewWidget::set_train_speed(int speed)
+{
+    m_train_speed = (float)speed / 500;
+    if (m_train_obj_p)
+        m_train_obj_p->set_train_speed(m_train_speed);
+}
+
 void ViewWidget::set_water_reflect_refract(Water::ReflectRefract type, float factor)
 {
     this->makeCurrent();
@@ -378,14 +427,14 @@ void ViewWidget::set_Cel_Levels(int levels)
 
 void ViewWidget::import_control_points()
 {
-    QString path = QFileDialog::getOpenFileName(nullptr, "Import Control Points", ".", "Text (*.txt)");
+    QString path = QFileDialog::getOpenFileName(nullptr, "Import Control Points", ".", "Track (*.trk *.txt);;Binary (*.trk);;Text (*.txt)");
     if (path.isEmpty()) return;
     m_train_obj_p->import_control_points(path.toStdString());
 }
 
 void ViewWidget::export_control_points()
 {
-    QString path = QFileDialog::getSaveFileName(nullptr, "Export Control Points", ".", "Text (*.txt)");
+    QString path = QFileDialog::getSaveFileName(nullptr, "Export Control Points", ".", "Text (*.txt);;Binary (*.trk)");
     if (path.isEmpty()) return;
     m_train_obj_p->export_control_points(path.toStdString());
 }
@@ -9,6 +9,7 @@
 #include <ArcBall.h>
 #include <qtTextureCubeMap.h>
 #include <UBO.h>
+#include <StreamBuffer.h>
 #include <Box_VAO.h>
 #include <Shader.h>
 #include <Model.h>
@@ -49,6 +50,8 @@
  *    vec4 plane;
  * } Clip;
  * ```
+ * Matrices、Light、Clip 每個pass（反射、折射、最終畫面）都不同，每個pass寫進 m_pass_uniforms_p 的新位置，
+ * 再用 glBindBufferRange 綁定，不會覆寫GPU可能還在用的資料。
  */
 class ViewWidget : public QOpenGLWidget
 {
@@ -63,16 +66,14 @@ private:
     /// 開始拖動的點
     QPoint m_start_drag_point;
 
-    /// view matrix & projection matrix
+    /// projection matrix
     glm::mat4 m_proj_matrix;
-    std::unique_ptr<UBO> m_matrices_UBO_p;
 
-    /// light UBO
-    std::unique_ptr<UBO> m_light_UBO_p;
-    std::unique_ptr<UBO> m_cel_shading_p; ///< {int: on/off, int: levels}
+    /// 每個pass的 Matrices、Light、Clip
+    std::unique_ptr<StreamBuffer> m_pass_uniforms_p;
+    GLint m_UBO_alignment; ///< GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
 
-    /// Clip Plane
-    std::unique_ptr<UBO> m_clip_UBO_p; ///< 內含4-tuple，同glClipPlane，但是在世界座標下的平面
+    std::unique_ptr<UBO> m_cel_shading_p; ///< {int: on/off, int: levels}
 
     /// skybox
     std::unique_ptr<Skybox> m_skybox_obj_p;
@@ -84,7 +85,7 @@ private:
 
     // train
     std::unique_ptr<TrainSystem> m_train_obj_p;
-    float m_train_speed; ///< 火車的速度
+    float m_train_speed; ///< 火車的速度（每 TrainSimulation::step_seconds() 秒前進的距離）
 
     // island
     std::unique_ptr<Island> m_island_obj_p;
@@ -111,7 +112,14 @@ public:
 private:
     void update_view_from_arc_ball();
 
+    /**
+     * @brief 將目前的視角、光源和clip plane寫進 m_pass_uniforms_p，並綁定到 binding 0、1、3
+     * @param clip - 同glClipPlane，但是在世界座標下的平面
+     */
+    void bind_pass_uniforms(const float clip[4]);
+
     /// 點在視窗的winPos，並對每個物件處理點擊事件
+    /// @details 從滑鼠的位置射出射線，在CPU上和控制點、島、水面做相交測試，不讀回depth buffer
     void process_click_for_obj(QPoint winPos, bool is_drag);
 
 protected:
@@ -157,7 +165,7 @@ public slots:
     void delete_train_CP() { m_train_obj_p->delete_CP(); }
 
     /// 設定速度
-    void set_train_speed(int speed) { m_train_speed = (float)speed / 500; }
+    void set_train_speed(int speed);
 
     void toggle_wireframe(bool on);
 
@@ -177,6 +185,10 @@ signals:
     /// 轉發TrainSystem的signal。
     /// 見 TrainSystem::is_point_selected
     void is_point_selected(bool select);
+
+    /// 轉發TrainSystem的signal。
+    /// 見 TrainSystem::lap_time_changed
+    void lap_time_changed(float seconds);
 };
 
 #endif // VIEWWIDGET_H
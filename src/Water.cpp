@@ -5,57 +5,54 @@
 #include <iostream>
 
 constexpr float WAVE_SIZE = 6.f;
+/// height map 有幾幀
+constexpr size_t HEIGHT_MAP_NUM = 200;
 
 Water::Water()
-    : m_water_shader("shader/wave.vert", nullptr, nullptr, nullptr, "shader/wave.frag"), m_water_vao(WAVE_SIZE), m_frame(0), m_height_maps(),
+    : m_water_shader("shader/wave.vert", nullptr, nullptr, nullptr, "shader/wave.frag"),
+    m_uniform_frame(m_water_shader.uniform<GLuint>("frame")), m_uniform_use_height_map(m_water_shader.uniform<GLint>("use_height_map")),
+    m_uniform_height_map_layer(m_water_shader.uniform<GLint>("height_map_layer")),
+    m_uniform_how_to_render(m_water_shader.uniform<GLuint>("how_to_render")), m_uniform_factor(m_water_shader.uniform<GLfloat>("factor")),
+    m_water_vao(WAVE_SIZE), m_frame(0), m_height_maps(":/height_maps/%1.png", HEIGHT_MAP_NUM),
     m_current_height_map(0), m_state(SINE_WAVE)
 {
-    m_water_shader.Use();
-    glUniform1i(glGetUniformLocation(m_water_shader.Program, "height_map"), 0);
-    glUniform1i(glGetUniformLocation(m_water_shader.Program, "reflection_texture"), 1);
-    glUniform1i(glGetUniformLocation(m_water_shader.Program, "refraction_texture"), 2);
-    glUniform1f(glGetUniformLocation(m_water_shader.Program, "WAVE_SIZE"), WAVE_SIZE);
-    glUniform1i(glGetUniformLocation(m_water_shader.Program, "use_height_map"), false);
-
-    // 載入200張height map
-    QString path_pattern(":/height_maps/%1.png");
-    char num[4] = "000";
-    for (int i = 0; i < 200; ++i) {
-        m_height_maps.emplace_back(path_pattern.arg(QString(num)));
-
-        // num += 1
-        for (int digit = 2; digit >= 0; --digit) {
-            if (num[digit] == '9') {
-                num[digit] = '0';
-            }
-            else {
-                num[digit] += 1;
-                break;
-            }
-        }
-    }
+    m_water_shader.uniform<GLint>("height_map").set(0);
+    m_water_shader.uniform<GLint>("reflection_texture").set(1);
+    m_water_shader.uniform<GLint>("refraction_texture").set(2);
+    m_water_shader.uniform<GLint>("height_map_array").set(3);
+    m_water_shader.uniform<GLfloat>("WAVE_SIZE").set(WAVE_SIZE);
+    m_uniform_use_height_map.set(false);
+    m_uniform_height_map_layer.set(-1);
 }
 
 void Water::draw(bool wireframe, FBO &reflection, FBO &refraction)
 {
     m_water_shader.Use();
 
+    // 還沒有任何一幀height map載入時先畫sine wave
+    const int layer = m_state == HEIGHT_MAP ? m_height_maps.acquire(m_current_height_map) : -1;
+
     switch(m_state) {
+    case HEIGHT_MAP:
+        if (layer >= 0) {
+            m_height_maps.bind_to(3);
+            m_current_height_map = (m_current_height_map + 1) % m_height_maps.size();
+            m_uniform_height_map_layer.set(layer);
+            m_uniform_use_height_map.set(true);
+            break;
+        }
+        [[fallthrough]];
     case SINE_WAVE:
         ++m_frame;
-        glUniform1ui(glGetUniformLocation(m_water_shader.Program, "frame"), m_frame);
-        glUniform1i(glGetUniformLocation(m_water_shader.Program, "use_height_map"), false);
+        m_uniform_frame.set(m_frame);
+        m_uniform_use_height_map.set(false);
         break;
     case RIPPLE:
         m_ripple_map.update();
         m_ripple_map.bind(0);
         m_water_shader.Use();
-        glUniform1i(glGetUniformLocation(m_water_shader.Program, "use_height_map"), true);
-        break;
-    case HEIGHT_MAP:
-        m_height_maps[m_current_height_map].bind_to(0);
-        m_current_height_map = (m_current_height_map + 1) % m_height_maps.size();
-        glUniform1i(glGetUniformLocation(m_water_shader.Program, "use_height_map"), true);
+        m_uniform_height_map_layer.set(-1);
+        m_uniform_use_height_map.set(true);
         break;
     }
 
@@ -85,9 +82,7 @@ bool Water::process_click(glm::vec3 world_pos)
 
 void Water::setReflectRefract(ReflectRefract type, float factor)
 {
-    m_water_shader.Use();
-    glUniform1ui(glGetUniformLocation(m_water_shader.Program, "how_to_render"), (int)type);
-    glUniform1f(glGetUniformLocation(m_water_shader.Program, "factor"), factor);
-    glUseProgram(0);
+    m_uniform_how_to_render.set(static_cast<GLuint>(type));
+    m_uniform_factor.set(factor);
 }
 
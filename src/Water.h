@@ -11,8 +11,8 @@
 #include <Wave_VAO.h>
 #include <glm/vec3.hpp>
 #include <vector>
-#include <qtTextureImage2D.h>
 #include <FBO.h>
+#include "HeightMapSequence.h"
 
 /// water
 class Water
@@ -26,11 +26,16 @@ public:
 
 private:
     Shader m_water_shader;  //!< 繪製水波的shader
+    Shader::Uniform<GLuint> m_uniform_frame;          //!< uniform frame
+    Shader::Uniform<GLint> m_uniform_use_height_map;  //!< uniform use_height_map
+    Shader::Uniform<GLint> m_uniform_height_map_layer; //!< uniform height_map_layer
+    Shader::Uniform<GLuint> m_uniform_how_to_render;  //!< uniform how_to_render
+    Shader::Uniform<GLfloat> m_uniform_factor;        //!< uniform factor
     Wave_VAO m_water_vao;   //!< VAO
     DynamicHeightMap m_ripple_map; //!<
     GLuint m_frame;  //!<
 
-    std::vector<qtTextureImage2D> m_height_maps;
+    HeightMapSequence m_height_maps; //!< 第一次使用 HEIGHT_MAP 時才在背景載入
     size_t m_current_height_map;
 
     enum {
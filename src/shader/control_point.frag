@@ -1,8 +1,7 @@
 #version 430 core
 in vec3 vs_world_pos;
 in vec3 vs_normal;
-
-uniform bool is_selected;
+flat in int vs_is_selected;
 
 out vec4 FragColor;
 
@@ -39,6 +38,6 @@ void main() {
     specular = floor(specular * Cel.levels) / Cel.levels;
   }
 
-  vec4 vs_color = (is_selected ? vec4(1, 0, 0, 1) : vec4(1, 1, 1, 1));
+  vec4 vs_color = (vs_is_selected != 0 ? vec4(1, 0, 0, 1) : vec4(1, 1, 1, 1));
   FragColor =  min(vs_color * color_ambient, vec4(1.0)) + diffuse * color_diffuse + specular * color_specular;
 }
@@ -2,6 +2,10 @@
 
 layout(location = 0) in vec3 aPos;
 layout(location = 2) in vec3 aNormal;
+// 每個控制點（instance）的資料
+layout(location = 3) in vec3 aCpPos;
+layout(location = 4) in vec3 aCpOrient;
+layout(location = 5) in float aSelected;
 
 layout(std140, binding = 0) uniform MatricesBlock {
   uniform mat4 view;
@@ -10,13 +14,31 @@ layout(std140, binding = 0) uniform MatricesBlock {
 layout (std140, binding = 3) uniform ClipBlock {
   vec4 plane;
 } Clip;
-uniform mat4 model_matrix;
 
 out vec3 vs_world_pos;
 out vec3 vs_normal;
+flat out int vs_is_selected;
 
+// 生成一個旋轉矩陣，當y軸朝上時，逆時針轉angle弧（右手定則）
+mat4 rotationY(float angle) {
+  return mat4(cos(angle), 0, -sin(angle), 0,
+              0,          1,          0, 0,
+              sin(angle), 0, cos(angle), 0,
+              0,          0,          0, 1);
+}
+// 生成一個旋轉矩陣，當z軸朝上時，逆時針轉angle弧（右手定則）
+mat4 rotationZ(float angle) {
+  return mat4(cos(angle),  sin(angle), 0, 0,
+              -sin(angle), cos(angle), 0, 0,
+              0,           0,          1, 0,
+              0,           0,          0, 1);
+}
 
 void main() {
+  // model = translate(pos) * rotate(-atan(z, x), Y) * rotate(-acos(y), Z)
+  mat4 model_matrix = rotationY(-atan(aCpOrient.z, aCpOrient.x)) * rotationZ(-acos(clamp(aCpOrient.y, -1.0, 1.0)));
+  model_matrix[3] = vec4(aCpPos, 1);
+
   vec4 world_pos = model_matrix * vec4(aPos, 1);
   vs_world_pos = world_pos.xyz;
   gl_Position = Matrices.proj * Matrices.view * world_pos;
@@ -24,4 +46,5 @@ void main() {
 
   vec4 normal = model_matrix * vec4(aNormal, 0);
   vs_normal = normalize(normal.xyz);
+  vs_is_selected = int(aSelected);
 }
@@ -1,7 +1,7 @@
 #version 430 core
-in vec2 vs_texcoord;
+in vec3 vs_texcoord; // z: texture array 的第幾層
 
-uniform sampler2D img;
+uniform sampler2DArray img;
 
 out vec4 FragColor;
 
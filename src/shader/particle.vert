@@ -1,7 +1,8 @@
 #version 430 core
 layout(location = 0) in vec2 aPos;
 layout(location = 1) in vec2 aTexCoord;
-layout(location = 2) in vec3 aTranslate;
+layout(location = 2) in vec4 aTranslate; // xyz: 位置，w < 0 代表已經死掉
+layout(location = 3) in uint aEffect;    // 屬於哪個特效
 
 layout(std140, binding = 0) uniform MatricesBlock {
   uniform mat4 view;
@@ -14,9 +15,17 @@ layout (std140, binding = 1) uniform LightBlock {
 layout (std140, binding = 3) uniform ClipBlock {
   vec4 plane;
 } Clip;
-uniform float size;
 
-out vec2 vs_texcoord;
+struct Effect {
+  vec4 velocity_size;      // w: 大小
+  vec4 TTL_velocity_layer; // w: texture array 的第幾層
+  uint on_CPU;
+};
+layout(std430, binding = 2) readonly buffer EffectBlock {
+  Effect effects[];
+};
+
+out vec3 vs_texcoord; // z: texture array 的第幾層
 
 // Reference: wikipedia
 // 生成一個旋轉矩陣，當x軸朝上時，逆時針轉angle弧（右手定則）
@@ -34,7 +43,17 @@ mat4 rotationY(float angle) {
 }
 
 void main() {
-  vec3 eye = Light.eye_position.xyz - aTranslate;
+  if (aTranslate.w < 0) { // 丟到clip space外面
+    gl_Position = vec4(2, 2, 2, 1);
+    vs_texcoord = vec3(aTexCoord, 0);
+    gl_ClipDistance[0] = -1;
+    return;
+  }
+
+  Effect e = effects[aEffect];
+  float size = e.velocity_size.w;
+
+  vec3 eye = Light.eye_position.xyz - aTranslate.xyz;
 
   mat4 rotate;
   float theta1 = atan(eye.y / abs(eye.z));
@@ -44,9 +63,9 @@ void main() {
   rotate = rotationY(theta2) * rotate;
 
   vec4 world_pos = rotate * vec4(size * aPos, 0, 1);
-  world_pos.xyz += aTranslate;
+  world_pos.xyz += aTranslate.xyz;
   gl_Position = Matrices.proj * Matrices.view * world_pos;
-  vs_texcoord = aTexCoord;
+  vs_texcoord = vec3(aTexCoord, e.TTL_velocity_layer.w);
 
   gl_ClipDistance[0] = dot(Clip.plane, world_pos);
 }
@@ -0,0 +1,26 @@
+#version 430 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec3 aNormal;
+
+layout(std140, binding = 0) uniform MatricesBlock {
+  uniform mat4 view;
+  uniform mat4 proj;
+} Matrices;
+layout (std140, binding = 3) uniform ClipBlock {
+  vec4 plane;
+} Clip;
+
+out vec3 vs_world_pos;
+out vec3 vs_normal;
+
+
+// 頂點已經在世界座標中
+void main() {
+  vec4 world_pos = vec4(aPos, 1);
+  vs_world_pos = aPos;
+  gl_Position = Matrices.proj * Matrices.view * world_pos;
+  gl_ClipDistance[0] = dot(Clip.plane, world_pos);
+
+  vs_normal = normalize(aNormal);
+}
@@ -0,0 +1,27 @@
+#version 430 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 2) in vec3 aNormal;
+layout(location = 3) in mat4 aModel; // 每個枕木的model matrix
+
+layout(std140, binding = 0) uniform MatricesBlock {
+  uniform mat4 view;
+  uniform mat4 proj;
+} Matrices;
+layout (std140, binding = 3) uniform ClipBlock {
+  vec4 plane;
+} Clip;
+
+out vec3 vs_world_pos;
+out vec3 vs_normal;
+
+
+void main() {
+  vec4 world_pos = aModel * vec4(aPos, 1);
+  vs_world_pos = world_pos.xyz;
+  gl_Position = Matrices.proj * Matrices.view * world_pos;
+  gl_ClipDistance[0] = dot(Clip.plane, world_pos);
+
+  // aModel只有旋轉和沿著軸的縮放，而方塊的法向量都和軸平行，所以縮放不會改變法向量的方向
+  vs_normal = normalize(mat3(aModel) * aNormal);
+}
@@ -0,0 +1,41 @@
+#version 430 core
+in vec3 vs_world_pos;
+in vec3 vs_normal;
+
+out vec4 FragColor;
+
+
+layout (std140, binding = 1) uniform LightBlock {
+  vec4 eye_position;
+  vec4 light_position;
+} Light;
+// 鐵軌和枕木共用，材質由 TrainSystem 設定
+uniform vec4 color;
+uniform vec4 color_specular;
+uniform float shininess;
+
+layout (std140, binding = 2) uniform Cel_Shading_Block {
+  int on;
+  int levels;
+} Cel;
+
+void main() {
+  vec3 light_direction;
+  if (Light.light_position.w == 0) {
+    light_direction = normalize(Light.light_position.xyz);
+  }
+  else {
+    light_direction = normalize(Light.light_position.xyz - vs_world_pos);
+  }
+  vec3 EyeDirection = normalize(Light.eye_position.xyz - vs_world_pos);
+  vec3 half_vector = normalize(light_direction + EyeDirection);
+
+  float diffuse = max(0.0, dot(vs_normal, light_direction));
+  float specular = pow(max(0.0, dot(vs_normal, half_vector)), shininess);
+  if (Cel.on == 1) {
+    diffuse = floor(diffuse * Cel.levels) / Cel.levels;
+    specular = floor(specular * Cel.levels) / Cel.levels;
+  }
+
+  FragColor = color * (0.4 + 0.6 * diffuse) + specular * color_specular;
+}
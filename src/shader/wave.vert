@@ -6,7 +6,9 @@ layout(std140, binding = 0) uniform MatricesBlock {
   uniform mat4 proj;
 } Matrices;
 uniform uint frame;
-uniform sampler2D height_map;
+uniform sampler2D height_map;             // ripple
+uniform sampler2DArray height_map_array;  // 預先算好的height map，每層一幀
+uniform int height_map_layer;             // 小於0時用 height_map，否則用 height_map_array 的這一層
 uniform float WAVE_SIZE;
 uniform bool use_height_map;
 
@@ -16,23 +18,29 @@ out vec3 vs_normal;
 
 const float move_down = 0.3;
 
+vec4 height_at(vec2 uv) {
+  if (height_map_layer < 0)
+    return texture(height_map, uv);
+  return texture(height_map_array, vec3(uv, height_map_layer));
+}
+
 void main() {
   gl_ClipDistance[0] = 0;
   if (use_height_map) {
     vec2 TexCoord = clamp((vec2(pos.x , pos.z) + WAVE_SIZE) / (2.f * WAVE_SIZE), 0, 1);
     float scale = 0.02;
 
-    vec4 info = texture2D(height_map, TexCoord);
+    vec4 info = height_at(TexCoord);
     vs_world_pos = vec3(pos.x, (info.r * scale) - move_down, pos.z);
     gl_Position = Matrices.proj * Matrices.view * vec4(vs_world_pos, 1);
     vs_clipspace = gl_Position;
 
     float delta = 0.00005;
     // TexCoord上x加delta後，y的變化量
-    float dy_x = (texture2D(height_map, TexCoord + vec2(delta, 0)) - info).r;
+    float dy_x = (height_at(TexCoord + vec2(delta, 0)) - info).r;
     dy_x *= scale;
     // TexCoord上z加delta後，y的變化量
-    float dy_z = (texture2D(height_map, TexCoord + vec2(0, delta)) - info).r;
+    float dy_z = (height_at(TexCoord + vec2(0, delta)) - info).r;
     dy_z *= scale;
 
     vs_normal = normalize(
@@ -1,6 +1,8 @@
 #version 430 core
 layout(location = 0) in vec3 aPos;
 layout(location = 2) in vec3 aNormal;
+// 每個支柱（instance）頂端的位置
+layout(location = 3) in vec3 aCpPos;
 
 layout(std140, binding = 0) uniform MatricesBlock {
   uniform mat4 view;
@@ -12,8 +14,6 @@ layout (std140, binding = 3) uniform ClipBlock {
 
 out vec3 vs_texCoord;
 
-// Control Point的位置
-uniform vec3 cp_pos;
 // Control Point的大小
 uniform float cp_size;
 
@@ -21,7 +21,7 @@ void main() {
   // scale
   vec3 world_pos = aPos * cp_size;
   // translate
-  world_pos += cp_pos;
+  world_pos += aCpPos;
   world_pos.y -= 2 * cp_size;
 
   // 朝上的面
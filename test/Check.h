@@ -0,0 +1,70 @@
+/**
+ * @file Check.h
+ * @brief 單元測試用的檢查巨集
+ * @details
+ * 檢查失敗時印出檔名、行號和條件，並記下失敗的次數，不會中止測試。
+ * main() 最後 `return Check::result();`，有任何檢查失敗時回傳 EXIT_FAILURE，ctest 就會判定失敗。
+ */
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Check {
+
+/// 到目前為止失敗的次數
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline bool report(bool ok, const char* file, int line, const char* expr)
+{
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+        ++failures();
+    }
+    return ok;
+}
+
+inline bool report_near(double a, double b, double tol, const char* file, int line, const char* expr)
+{
+    const bool ok = std::abs(a - b) <= tol;
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: CHECK_NEAR failed: %s (%.9g vs %.9g, tolerance %.3g)\n", file, line, expr, a, b, tol);
+        ++failures();
+    }
+    return ok;
+}
+
+/// 印出結果，並回傳給 main() 的回傳值
+inline int result()
+{
+    if (failures() == 0) {
+        std::printf("all checks passed\n");
+        return EXIT_SUCCESS;
+    }
+    std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return EXIT_FAILURE;
+}
+
+}
+
+/// cond 須為true
+#define CHECK(cond) Check::report(static_cast<bool>(cond), __FILE__, __LINE__, #cond)
+
+/// |a - b| <= tol
+#define CHECK_NEAR(a, b, tol) Check::report_near((a), (b), (tol), __FILE__, __LINE__, #a " ~ " #b)
+
+/// expr 須丟出 ExceptionT
+#define CHECK_THROWS(expr, ExceptionT) \
+    do { \
+        bool thrown_ = false; \
+        try { expr; } catch (const ExceptionT&) { thrown_ = true; } \
+        Check::report(thrown_, __FILE__, __LINE__, "throws " #ExceptionT ": " #expr); \
+    } while (0)
+
+#endif // CHECK_H
@@ -0,0 +1,66 @@
+/**
+ * @file TestTrack.h
+ * @brief 單元測試共用的軌道
+ */
+#ifndef TESTTRACK_H
+#define TESTTRACK_H
+
+#include "TrackCurve.h"
+#include <glm/geometric.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace TestTrack {
+
+constexpr float Tension = 0.5f;     ///< 同 TrainSystem 的預設值
+constexpr float Tolerance = 1.e-3f; ///< 同 TrainSystem 的預設值
+
+const SplineType Spline_Types[] = { SplineType::LINEAR, SplineType::CARDINAL, SplineType::CUBIC_B };
+
+/// TrainSystem::reset_CP() 的正方形軌道
+inline std::vector<ControlPoint> square()
+{
+    const glm::vec3 up(0, 1, 0);
+    return {
+        { glm::vec3(2, 0, 0), up },
+        { glm::vec3(0, 0, 2), up },
+        { glm::vec3(-2, 0, 0), up },
+        { glm::vec3(0, 0, -2), up },
+    };
+}
+
+/// 繞一圈、上下起伏的軌道，相鄰控制點的距離不一
+inline std::vector<ControlPoint> wavy(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+
+    const float radius = std::max(2.f, n / 6.2831853f);
+    std::vector<ControlPoint> control_points(n);
+    for (size_t i = 0; i < n; ++i) {
+        const float theta = 6.2831853f * i / n;
+        control_points[i].pos = glm::vec3(radius * std::cos(theta) + jitter(rng),
+                                          2.f + std::sin(3 * theta) + jitter(rng),
+                                          radius * std::sin(theta) + jitter(rng));
+        control_points[i].orient = glm::vec3(jitter(rng), 1, jitter(rng));
+    }
+    return control_points;
+}
+
+/// 把第i段曲線切成 steps 份的折線長度，用來當作曲線長的參考值
+inline double dense_length(const TrackCurve& track, size_t i, int steps = 4096)
+{
+    double length = 0;
+    glm::vec3 prev = track.pos_segment(i)(0.f);
+    for (int k = 1; k <= steps; ++k) {
+        const glm::vec3 p = track.pos_segment(i)(float(k) / steps);
+        length += glm::length(p - prev);
+        prev = p;
+    }
+    return length;
+}
+
+}
+
+#endif // TESTTRACK_H
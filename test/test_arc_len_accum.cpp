@@ -0,0 +1,135 @@
+/**
+ * @file test_arc_len_accum.cpp
+ * @brief ArcLenAccum 的單元測試：查表的精確度、均勻表和二分搜尋一致、T→S→T 來回
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include <random>
+
+namespace {
+
+/// 每段曲線終點的累積長度和折線的參考值比較
+void test_accuracy()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        for (const auto& control_points : { TestTrack::square(), TestTrack::wavy(24, 1) }) {
+            TrackCurve track;
+            track.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+            double S = 0;
+            for (size_t i = 0; i < track.segment_num(); ++i) {
+                CHECK_NEAR(track.T_to_S(float(i)), S, 2 * TestTrack::Tolerance * (i + 1));
+                S += TestTrack::dense_length(track, i);
+            }
+            CHECK_NEAR(track.length(), S, 2 * TestTrack::Tolerance * track.segment_num());
+
+            // 段內的點也要準：在 1/4、1/2、3/4 處比較
+            for (size_t i = 0; i < track.segment_num(); ++i) {
+                const double start = track.T_to_S(float(i));
+                for (float t : { 0.25f, 0.5f, 0.75f }) {
+                    double partial = 0;
+                    glm::vec3 prev = track.pos_segment(i)(0.f);
+                    const int steps = 2048;
+                    for (int k = 1; k <= steps; ++k) {
+                        const glm::vec3 p = track.pos_segment(i)(t * k / steps);
+                        partial += glm::length(p - prev);
+                        prev = p;
+                    }
+                    CHECK_NEAR(track.T_to_S(i + t) - start, partial, 2 * TestTrack::Tolerance);
+                }
+            }
+        }
+    }
+}
+
+/// 直線的累積長度和T成正比，線性內插查表必須是精確的（包括轉角處）
+void test_linear_exact()
+{
+    TrackCurve track;
+    const auto control_points = TestTrack::wavy(32, 2);
+    track.rebuild(control_points, SplineType::LINEAR, TestTrack::Tension, TestTrack::Tolerance);
+
+    std::vector<double> start(control_points.size() + 1, 0.);
+    for (size_t i = 0; i < control_points.size(); ++i) {
+        const glm::vec3 d = control_points[(i + 1) % control_points.size()].pos - control_points[i].pos;
+        start[i + 1] = start[i] + glm::length(d);
+    }
+
+    const double eps = 1.e-5 * start.back();
+    for (size_t i = 0; i < control_points.size(); ++i) {
+        for (float t : { 0.f, 0.1f, 0.5f, 0.9f }) {
+            const double expected = start[i] + t * (start[i + 1] - start[i]);
+            CHECK_NEAR(track.T_to_S(i + t), expected, eps);
+            CHECK_NEAR(track.S_to_T(float(expected)), i + t, 1.e-4);
+        }
+    }
+}
+
+/// 有均勻表時的結果須和二分搜尋完全相同
+void test_uniform_matches_bsearch()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        TrackCurve track;
+        track.rebuild(TestTrack::wavy(64, 3), type, TestTrack::Tension, TestTrack::Tolerance);
+        const ArcLenAccum& accum = track.arc_len_accum();
+        CHECK(accum.has_uniform_table());
+
+        std::mt19937 rng(4);
+        std::uniform_real_distribution<float> T_dist(0.f, accum.max_T()), S_dist(0.f, accum.max_S());
+        int T_mismatch = 0, S_mismatch = 0;
+        for (int k = 0; k < 100000; ++k) {
+            const float T = T_dist(rng), S = S_dist(rng);
+            T_mismatch += accum.T_to_S(T) != accum.T_to_S_bsearch(T);
+            S_mismatch += accum.S_to_T(S) != accum.S_to_T_bsearch(S);
+        }
+        // 原始表中的每個取樣點本身也要一致
+        for (const auto& entry : accum.table()) {
+            T_mismatch += accum.T_to_S(entry.first) != accum.T_to_S_bsearch(entry.first);
+            S_mismatch += accum.S_to_T(entry.second) != accum.S_to_T_bsearch(entry.second);
+        }
+        CHECK(T_mismatch == 0);
+        CHECK(S_mismatch == 0);
+    }
+}
+
+/// T→S→T 和 S→T→S 來回後回到原處，超出範圍的值會wrap
+void test_round_trip()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        TrackCurve track;
+        track.rebuild(TestTrack::wavy(16, 5), type, TestTrack::Tension, TestTrack::Tolerance);
+        const float max_T = track.arc_len_accum().max_T();
+        const float length = track.length();
+
+        for (int k = 0; k < 1000; ++k) {
+            const float T = max_T * k / 1000;
+            CHECK_NEAR(track.S_to_T(track.T_to_S(T)), T, 1.e-4);
+            const float S = length * k / 1000;
+            CHECK_NEAR(track.T_to_S(track.S_to_T(S)), S, 1.e-4 * length);
+        }
+
+        // S 增加時 T 不會減少
+        float prev = -1.f;
+        bool monotonic = true;
+        for (int k = 0; k < 1000; ++k) {
+            const float T = track.S_to_T(length * k / 1000);
+            monotonic = monotonic && T >= prev;
+            prev = T;
+        }
+        CHECK(monotonic);
+
+        CHECK_NEAR(track.S_to_T(length + 0.5f), track.S_to_T(0.5f), 1.e-3);
+        CHECK_NEAR(track.S_to_T(-0.5f), track.S_to_T(length - 0.5f), 1.e-3);
+    }
+}
+
+}
+
+int main()
+{
+    test_accuracy();
+    test_linear_exact();
+    test_uniform_matches_bsearch();
+    test_round_trip();
+    return Check::result();
+}
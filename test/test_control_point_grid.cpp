@@ -0,0 +1,229 @@
+/**
+ * @file test_control_point_grid.cpp
+ * @brief ControlPointGrid 的單元測試：點擊、框選和找最近的控制點的結果須和逐一檢查所有控制點一樣
+ */
+#include "Check.h"
+#include "ControlPointGrid.h"
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr float Cell_Size = 1.f;
+/// 點擊的範圍：[p - Lower, p + Upper]，上下不對稱（同控制點的尖角）
+const glm::vec3 Lower(0.75f, 0.25f, 0.75f);
+const glm::vec3 Upper(0.75f, 0.5f, 0.75f);
+
+/// 逐一檢查所有控制點，條件同 ControlPointGrid::pick()
+int brute_force_pick(const std::vector<ControlPoint>& control_points, const glm::vec3& pos)
+{
+    for (size_t i = 0; i < control_points.size(); ++i) {
+        const glm::vec3 delta = pos - control_points[i].pos;
+        if (delta.x >= -Lower.x && delta.y >= -Lower.y && delta.z >= -Lower.z &&
+            delta.x <= Upper.x && delta.y <= Upper.y && delta.z <= Upper.z)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::vector<ControlPoint> random_points(size_t n, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> xz(-20.f, 20.f), y(-1.f, 1.f);
+    std::vector<ControlPoint> control_points(n);
+    for (ControlPoint& cp : control_points)
+        cp = { glm::vec3(xz(rng), y(rng), xz(rng)), glm::vec3(0, 1, 0) };
+    return control_points;
+}
+
+/// 隨機點擊，比較結果（包括格子的邊界附近和負的座標）
+int count_mismatch(const ControlPointGrid& grid, const std::vector<ControlPoint>& control_points, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> xz(-21.f, 21.f), y(-1.5f, 1.5f);
+    std::uniform_int_distribution<size_t> pick_cp(0, control_points.size() - 1);
+    std::uniform_real_distribution<float> near(-1.f, 1.f);
+
+    int mismatch = 0;
+    for (int k = 0; k < 20000; ++k) {
+        glm::vec3 pos;
+        if (k % 2 == 0) // 控制點附近，大部分會點到
+            pos = control_points[pick_cp(rng)].pos + glm::vec3(near(rng), 0.5f * near(rng), near(rng));
+        else
+            pos = glm::vec3(xz(rng), y(rng), xz(rng));
+        mismatch += grid.pick(pos, Lower, Upper) != brute_force_pick(control_points, pos);
+    }
+    return mismatch;
+}
+
+void test_pick()
+{
+    std::mt19937 rng(19);
+    auto control_points = random_points(500, rng);
+    ControlPointGrid grid(Cell_Size);
+    CHECK(grid.pick(glm::vec3(0), Lower, Upper) == -1);
+
+    grid.rebuild(control_points);
+    CHECK(count_mismatch(grid, control_points, rng) == 0);
+
+    // 拖移：有些留在同一格，有些移到別的格子
+    std::uniform_int_distribution<size_t> pick_cp(0, control_points.size() - 1);
+    std::uniform_real_distribution<float> small(-0.2f, 0.2f), large(-10.f, 10.f);
+    for (int k = 0; k < 300; ++k) {
+        const size_t i = pick_cp(rng);
+        const float d = (k % 2 == 0) ? small(rng) : large(rng);
+        control_points[i].pos += glm::vec3(d, 0.f, -d);
+        grid.move(static_cast<int>(i), control_points[i].pos);
+    }
+    CHECK(count_mismatch(grid, control_points, rng) == 0);
+
+    // 重疊的控制點回傳index最小的
+    control_points[7].pos = control_points[3].pos;
+    grid.rebuild(control_points);
+    CHECK(grid.pick(control_points[3].pos, Lower, Upper) == brute_force_pick(control_points, control_points[3].pos));
+    CHECK(grid.pick(control_points[3].pos, Lower, Upper) <= 3);
+}
+
+/// 範圍包含邊界：box的角和頂端都點得到，再往外一點就點不到
+void test_pick_boundary()
+{
+    const glm::vec3 p(0.25f, 0.5f, -0.5f); // 和範圍相加減沒有誤差
+    ControlPointGrid grid(Cell_Size);
+    grid.rebuild({ { p, glm::vec3(0, 1, 0) } });
+
+    CHECK(grid.pick(p + Upper, Lower, Upper) == 0);
+    CHECK(grid.pick(p - Lower, Lower, Upper) == 0);
+    CHECK(grid.pick(p + glm::vec3(Upper.x, -Lower.y, -Lower.z), Lower, Upper) == 0);
+    CHECK(grid.pick(p + glm::vec3(0.f, Upper.y + 1.e-4f, 0.f), Lower, Upper) == -1);
+    CHECK(grid.pick(p - glm::vec3(Lower.x + 1.e-4f, 0.f, 0.f), Lower, Upper) == -1);
+}
+
+/// 逐一檢查所有控制點，條件同 ControlPointGrid::query_box()
+std::vector<int> brute_force_box(const std::vector<ControlPoint>& control_points, const glm::vec3& min, const glm::vec3& max)
+{
+    std::vector<int> result;
+    for (size_t i = 0; i < control_points.size(); ++i) {
+        const glm::vec3& p = control_points[i].pos;
+        if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z)
+            result.push_back(static_cast<int>(i));
+    }
+    return result;
+}
+
+/// 第i個控制點和 pos 的距離平方
+float distance2(const std::vector<ControlPoint>& control_points, int i, const glm::vec3& pos)
+{
+    const glm::vec3 d = control_points[i].pos - pos;
+    return glm::dot(d, d);
+}
+
+/// nearest() 的結果須由近到遠，而且第k近的距離和逐一檢查的一樣（距離相同時index可能不同）
+bool nearest_matches(const ControlPointGrid& grid, const std::vector<ControlPoint>& control_points, const glm::vec3& pos, size_t n)
+{
+    std::vector<float> expected(control_points.size());
+    for (size_t i = 0; i < control_points.size(); ++i)
+        expected[i] = distance2(control_points, static_cast<int>(i), pos);
+    std::sort(expected.begin(), expected.end());
+    expected.resize(std::min(n, expected.size()));
+
+    const std::vector<int> result = grid.nearest(pos, n);
+    if (result.size() != expected.size())
+        return false;
+    for (size_t k = 0; k < result.size(); ++k) {
+        if (distance2(control_points, result[k], pos) != expected[k])
+            return false;
+    }
+    return true;
+}
+
+void test_query_box()
+{
+    std::mt19937 rng(7);
+    auto control_points = random_points(500, rng);
+    ControlPointGrid grid(Cell_Size);
+    CHECK(grid.query_box(glm::vec3(-100.f), glm::vec3(100.f)).empty());
+
+    grid.rebuild(control_points);
+    std::uniform_real_distribution<float> corner(-25.f, 25.f), extent(0.f, 8.f), y(-1.5f, 1.5f);
+    int mismatch = 0;
+    for (int k = 0; k < 2000; ++k) {
+        // 小框只走附近的格子，大框（包含整個範圍）直接檢查所有格子
+        const float scale = (k % 10 == 0) ? 10.f : 1.f;
+        const glm::vec3 min(corner(rng), y(rng), corner(rng));
+        const glm::vec3 max = min + glm::vec3(scale * extent(rng), std::abs(y(rng)), scale * extent(rng));
+        mismatch += grid.query_box(min, max) != brute_force_box(control_points, min, max);
+    }
+    CHECK(mismatch == 0);
+
+    // 框住全部；框在所有控制點外面；min > max 時是空的
+    CHECK(grid.query_box(glm::vec3(-100.f), glm::vec3(100.f)).size() == control_points.size());
+    CHECK(grid.query_box(glm::vec3(30.f, -1.f, 30.f), glm::vec3(40.f, 1.f, 40.f)).empty());
+    CHECK(grid.query_box(glm::vec3(5.f), glm::vec3(-5.f)).empty());
+
+    // 拖移後仍然正確
+    control_points[10].pos = glm::vec3(-19.5f, 0.f, 19.5f);
+    grid.move(10, control_points[10].pos);
+    const glm::vec3 min(-20.f, -1.f, 19.f), max(-19.f, 1.f, 20.f);
+    CHECK(grid.query_box(min, max) == brute_force_box(control_points, min, max));
+}
+
+void test_nearest()
+{
+    std::mt19937 rng(13);
+    auto control_points = random_points(500, rng);
+    ControlPointGrid grid(Cell_Size);
+    CHECK(grid.nearest(glm::vec3(0.f), 3).empty());
+
+    grid.rebuild(control_points);
+    CHECK(grid.nearest(glm::vec3(0.f), 0).empty());
+
+    std::uniform_real_distribution<float> xz(-30.f, 30.f), y(-1.5f, 1.5f);
+    int mismatch = 0;
+    for (int k = 0; k < 1000; ++k) {
+        const glm::vec3 pos(xz(rng), y(rng), xz(rng));
+        const size_t n = (k % 50 == 0) ? 600 : 1 + k % 20; // 偶爾要的比全部還多
+        mismatch += !nearest_matches(grid, control_points, pos, n);
+    }
+    // 離所有控制點很遠時也找得到
+    mismatch += !nearest_matches(grid, control_points, glm::vec3(500.f, 0.f, -500.f), 5);
+    CHECK(mismatch == 0);
+
+    // 最近的就是自己
+    CHECK(grid.nearest(control_points[42].pos, 1) == std::vector<int>{ 42 });
+}
+
+/// 座標超出int範圍的格子時不會溢位（會夾在邊界的格子），仍然點得到
+void test_huge_coordinates()
+{
+    std::vector<ControlPoint> control_points = {
+        { glm::vec3(1.e30f, 0.f, -1.e30f), glm::vec3(0, 1, 0) },
+        { glm::vec3(-3.e9f, 0.f, 5.e9f), glm::vec3(0, 1, 0) },
+        { glm::vec3(0.f), glm::vec3(0, 1, 0) },
+    };
+    ControlPointGrid grid(Cell_Size);
+    grid.rebuild(control_points);
+    for (size_t i = 0; i < control_points.size(); ++i)
+        CHECK(grid.pick(control_points[i].pos, Lower, Upper) == static_cast<int>(i));
+    CHECK(grid.pick(glm::vec3(1.e30f, 0.f, 1.e30f), Lower, Upper) == -1);
+    CHECK(grid.query_box(glm::vec3(-1.e31f), glm::vec3(1.e31f)) == brute_force_box(control_points, glm::vec3(-1.e31f), glm::vec3(1.e31f)));
+    CHECK(grid.query_box(glm::vec3(-1.f), glm::vec3(1.f)) == std::vector<int>{ 2 });
+    CHECK(nearest_matches(grid, control_points, glm::vec3(1.e30f, 0.f, 1.e30f), 3));
+    CHECK(nearest_matches(grid, control_points, glm::vec3(0.f), 2));
+
+    // 拖到很遠再拖回來
+    grid.move(2, glm::vec3(-1.e35f, 0.f, 0.f));
+    CHECK(grid.pick(glm::vec3(0.f), Lower, Upper) == -1);
+    grid.move(2, glm::vec3(0.f));
+    CHECK(grid.pick(glm::vec3(0.f), Lower, Upper) == 2);
+}
+
+}
+
+int main()
+{
+    test_pick();
+    test_pick_boundary();
+    test_query_box();
+    test_nearest();
+    test_huge_coordinates();
+    return Check::result();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_frame_table.cpp
+ * @brief FrameTable 的單元測試：座標系正交、位置和方向符合軌道、at_chain 和 at 一致
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include "FrameTable.h"
+#include <algorithm>
+
+namespace {
+
+constexpr float Interval = 0.05f;
+
+bool orthonormal(const FrameTable::Frame& frame, float eps)
+{
+    auto unit = [&](const glm::vec3& v) { return std::abs(glm::length(v) - 1.f) <= eps; };
+    return unit(frame.FRONT) && unit(frame.LEFT) && unit(frame.TOP)
+        && std::abs(glm::dot(frame.FRONT, frame.LEFT)) <= eps
+        && std::abs(glm::dot(frame.FRONT, frame.TOP)) <= eps
+        && std::abs(glm::dot(frame.LEFT, frame.TOP)) <= eps
+        && glm::length(glm::cross(frame.TOP, frame.FRONT) - frame.LEFT) <= eps;
+}
+
+void test_frames_follow_track()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        TrackCurve track;
+        track.rebuild(TestTrack::wavy(16, 11), type, TestTrack::Tension, TestTrack::Tolerance);
+        FrameTable frames(Interval);
+        CHECK(frames.empty());
+        frames.rebuild(track);
+        CHECK(!frames.empty());
+        CHECK_NEAR(frames.length(), track.length(), 1.e-6);
+
+        int bad_frame = 0, bad_pos = 0, bad_front = 0;
+        const int samples = 2000;
+        for (int k = 0; k < samples; ++k) {
+            const float S = track.length() * k / samples;
+            const FrameTable::Frame frame = frames.at(S);
+            bad_frame += !orthonormal(frame, 1.e-4f);
+
+            const float T = track.S_to_T(S);
+            float t;
+            const size_t cp_id = track.locate(T, t);
+            if (type == SplineType::LINEAR) {
+                // 直線的轉角處，座標系在轉角前後的取樣間內插，位置和方向都會切過轉角
+                const float end_S = (cp_id + 1 == track.segment_num()) ? track.length() : track.T_to_S(float(cp_id + 1));
+                if (std::min(S - track.T_to_S(float(cp_id)), end_S - S) < 2 * Interval)
+                    continue;
+            }
+            bad_pos += glm::length(frame.pos - track.point_at(T)) > 0.01f;
+
+            const glm::vec3 tangent = track.pos_segment(cp_id).derivative(t);
+            bad_front += glm::dot(frame.FRONT, glm::normalize(tangent)) < 0.99f;
+        }
+        CHECK(bad_frame == 0);
+        CHECK(bad_pos == 0);
+        CHECK(bad_front == 0);
+    }
+}
+
+/// orient 和前進方向垂直時，TOP 就是 orient
+void test_top_follows_orient()
+{
+    TrackCurve track;
+    track.rebuild(TestTrack::square(), SplineType::CARDINAL, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(Interval);
+    frames.rebuild(track);
+
+    for (int k = 0; k < 100; ++k) {
+        const FrameTable::Frame frame = frames.at(track.length() * k / 100);
+        CHECK(glm::dot(frame.TOP, glm::vec3(0, 1, 0)) > 0.999f);
+    }
+}
+
+/// at_chain 的每一項須和 at(head_S - offsets[k]) 一樣，包括往回繞過起點好幾圈
+void test_at_chain()
+{
+    TrackCurve track;
+    track.rebuild(TestTrack::wavy(8, 12), SplineType::CARDINAL, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(Interval);
+    frames.rebuild(track);
+
+    std::vector<float> offsets;
+    for (float d = 0.f; d < 3.f * track.length(); d += 0.37f)
+        offsets.push_back(d);
+    std::vector<FrameTable::Frame> chain(offsets.size());
+
+    for (float head_S : { 0.f, 1.f, track.length() - 0.01f, -2.f, 5.f * track.length() + 0.3f }) {
+        frames.at_chain(head_S, offsets.data(), offsets.size(), chain.data());
+        int mismatch = 0;
+        for (size_t k = 0; k < offsets.size(); ++k) {
+            const FrameTable::Frame expected = frames.at(head_S - offsets[k]);
+            mismatch += glm::length(chain[k].pos - expected.pos) > 1.e-3f
+                     || glm::dot(chain[k].FRONT, expected.FRONT) < 0.9999f
+                     || glm::dot(chain[k].TOP, expected.TOP) < 0.9999f;
+        }
+        CHECK(mismatch == 0);
+    }
+}
+
+/// 繞一圈回到起點時位置和方向連續
+void test_seam()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        TrackCurve track;
+        track.rebuild(TestTrack::wavy(16, 13), type, TestTrack::Tension, TestTrack::Tolerance);
+        FrameTable frames(Interval);
+        frames.rebuild(track);
+
+        const FrameTable::Frame before = frames.at(track.length() - 1.e-3f), after = frames.at(1.e-3f);
+        CHECK(glm::length(before.pos - after.pos) < 0.01f);
+        CHECK(glm::dot(before.TOP, after.TOP) > 0.99f);
+    }
+}
+
+/// @brief orient 無法決定上方時完全靠平行移動，繞一圈的扭轉（holonomy）要平均分散，不能集中在起點
+/// @details 繞兩圈的環狀結（不在同一平面上），平行移動繞一圈後 TOP 差了約0.8 rad
+void test_holonomy()
+{
+    std::vector<ControlPoint> control_points;
+    for (int i = 0; i < 12; ++i) {
+        const float theta = 6.2831853f * i / 12;
+        const float r = 4 + std::cos(3 * theta);
+        control_points.push_back({ glm::vec3(r * std::cos(2 * theta), 2 * std::sin(3 * theta), r * std::sin(2 * theta)), glm::vec3(0.f) });
+    }
+    TrackCurve track;
+    track.rebuild(control_points, SplineType::CARDINAL, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(Interval);
+    frames.rebuild(track);
+
+    // 在表中的每個座標系上比較相鄰兩個繞 FRONT 扭轉的角度，第0個和最後一個（起點）也要差不多
+    const int N = static_cast<int>(std::ceil(track.length() / Interval));
+    const float step = track.length() / N;
+    float max_turn = 0.f, seam_turn = 0.f;
+    FrameTable::Frame prev = frames.at((N - 1) * step);
+    for (int k = 0; k < N; ++k) {
+        const FrameTable::Frame frame = frames.at(k * step);
+        // 扣掉 FRONT 本身轉的部分
+        const glm::vec3 prev_top = glm::normalize(prev.TOP - glm::dot(prev.TOP, frame.FRONT) * frame.FRONT);
+        const float turn = std::acos(std::min(1.f, glm::dot(prev_top, frame.TOP)));
+        if (k == 0)
+            seam_turn = turn;
+        else
+            max_turn = std::max(max_turn, turn);
+        prev = frame;
+    }
+    CHECK(seam_turn <= 2 * max_turn + 1.e-3f);
+}
+}
+
+int main()
+{
+    test_frames_follow_track();
+    test_top_follows_orient();
+    test_at_chain();
+    test_seam();
+    test_holonomy();
+    return Check::result();
+}
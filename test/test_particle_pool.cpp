@@ -0,0 +1,102 @@
+/**
+ * @file test_particle_pool.cpp
+ * @brief ParticlePool 的單元測試：容量、TTL、swap-remove 後活著的粒子保持連續
+ */
+#include "Check.h"
+#include "ParticlePool.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+void test_add()
+{
+    ParticlePool pool(3);
+    CHECK(pool.capacity() == 3 && pool.size() == 0);
+    CHECK(!pool.add(glm::vec3(0), 0)); // TTL為0不會新增
+    CHECK(pool.add(glm::vec3(1, 0, 0), 2));
+    CHECK(pool.add(glm::vec3(2, 0, 0), 2));
+    CHECK(pool.add(glm::vec3(3, 0, 0), 2));
+    CHECK(!pool.add(glm::vec3(4, 0, 0), 2)); // 池滿
+    CHECK(pool.size() == 3);
+    CHECK(pool.positions()[2].x == 3.f && pool.TTLs()[2] == 2);
+
+    pool.clear();
+    CHECK(pool.size() == 0 && pool.capacity() == 3);
+}
+
+/// TTL為k的粒子活過k次update，第k+1次update時被刪除
+void test_TTL()
+{
+    ParticlePool pool(4);
+    pool.add(glm::vec3(0), 1);
+    pool.add(glm::vec3(0), 3);
+
+    pool.step();
+    CHECK(pool.size() == 2);
+    pool.step();
+    CHECK(pool.size() == 1 && pool.TTLs()[0] == 1);
+    pool.step();
+    pool.step();
+    CHECK(pool.size() == 0);
+}
+
+/// update() 傳入減一後的TTL，只改變活著的粒子
+void test_update()
+{
+    ParticlePool pool(4);
+    pool.add(glm::vec3(0), 2);
+    pool.add(glm::vec3(10, 0, 0), 1);
+
+    pool.update([](const glm::vec3& pos, unsigned TTL) { return pos + glm::vec3(0, static_cast<float>(TTL + 1), 0); });
+    CHECK(pool.size() == 2);
+    CHECK(pool.positions()[0].y == 2.f && pool.positions()[1].y == 1.f);
+
+    pool.update([](const glm::vec3& pos, unsigned) { return pos + glm::vec3(0, 0, 1); });
+    CHECK(pool.size() == 1);
+    CHECK(pool.positions()[0] == glm::vec3(0, 2, 1));
+}
+
+/// 隨機新增和刪除，和直接刪除的結果比較：活著的粒子相同（順序可以不同）
+void test_swap_remove()
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<unsigned> TTL(0, 6);
+    ParticlePool pool(64);
+    std::vector<std::pair<float, unsigned>> expected; // (id, TTL)
+
+    float id = 0;
+    for (int step = 0; step < 200; ++step) {
+        for (int k = 0; k < 5; ++k, ++id) {
+            const unsigned t = TTL(rng);
+            if (pool.add(glm::vec3(id, 0, 0), t))
+                expected.emplace_back(id, t);
+        }
+
+        pool.step();
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+                                      [](const std::pair<float, unsigned>& p) { return p.second == 0; }), expected.end());
+        for (auto& p : expected)
+            --p.second;
+
+        std::vector<std::pair<float, unsigned>> actual;
+        for (size_t i = 0; i < pool.size(); ++i)
+            actual.emplace_back(pool.positions()[i].x, pool.TTLs()[i]);
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        CHECK(actual == expected);
+        CHECK(pool.size() <= pool.capacity());
+    }
+}
+
+}
+
+int main()
+{
+    test_add();
+    test_TTL();
+    test_update();
+    test_swap_remove();
+    return Check::result();
+}
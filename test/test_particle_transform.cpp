@@ -0,0 +1,99 @@
+/**
+ * @file test_particle_transform.cpp
+ * @brief ParticleTransform 的單元測試：各個 batch transformer 的移動量、多執行緒的結果和單一執行緒相同
+ */
+#include "Check.h"
+#include "ParticleTransform.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+void test_linear_drift_and_buoyancy()
+{
+    std::vector<glm::vec3> positions{ glm::vec3(0), glm::vec3(1, 2, 3) };
+    const std::vector<unsigned> TTLs{ 0, 4 };
+
+    ParticleTransform::linear_drift(glm::vec3(1, 0, -1))(positions.data(), TTLs.data(), positions.size());
+    CHECK(positions[0] == glm::vec3(1, 0, -1));
+    CHECK(positions[1] == glm::vec3(2, 2, 2));
+
+    // TTL越大移動越多
+    ParticleTransform::buoyancy(glm::vec3(0, 0.5f, 0))(positions.data(), TTLs.data(), positions.size());
+    CHECK(positions[0] == glm::vec3(1, 0, -1));
+    CHECK(positions[1] == glm::vec3(2, 4, 2));
+}
+
+void test_wind()
+{
+    std::vector<glm::vec3> positions{ glm::vec3(0, -3, 0), glm::vec3(0, 2, 0), glm::vec3(0, 8, 0) };
+    const std::vector<unsigned> TTLs(positions.size(), 1);
+
+    ParticleTransform::wind(glm::vec3(1, 0, 0), 4.f)(positions.data(), TTLs.data(), positions.size());
+    CHECK(positions[0].x == 0.f); // 低於0的高度沒有風
+    CHECK_NEAR(positions[1].x, 0.5, 1.e-6);
+    CHECK_NEAR(positions[2].x, 2.0, 1.e-6);
+}
+
+/// combine 依序套用，per_particle 和逐一呼叫相同
+void test_combine_and_per_particle()
+{
+    std::vector<glm::vec3> positions{ glm::vec3(0, 4, 0) };
+    const std::vector<unsigned> TTLs{ 2 };
+
+    // 先上升再吹風：風用上升後的高度
+    const ParticleTransform::Batch rise_then_wind = ParticleTransform::combine(
+        ParticleTransform::linear_drift(glm::vec3(0, 4, 0)), ParticleTransform::wind(glm::vec3(1, 0, 0), 8.f));
+    rise_then_wind(positions.data(), TTLs.data(), positions.size());
+    CHECK_NEAR(positions[0].x, 1.0, 1.e-6);
+    CHECK_NEAR(positions[0].y, 8.0, 1.e-6);
+
+    ParticleTransform::per_particle([](const glm::vec3& pos, unsigned TTL) {
+        return pos * static_cast<float>(TTL);
+    })(positions.data(), TTLs.data(), positions.size());
+    CHECK(positions[0] == glm::vec3(2, 16, 0));
+}
+
+/// 粒子很多時分給多個執行緒，結果和直接呼叫一次相同
+void test_apply_parallel()
+{
+    const size_t n = 3 * ParticleTransform::Parallel_Particles + 17;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> space(-10.f, 10.f);
+    std::uniform_int_distribution<unsigned> TTL(0, 30);
+
+    std::vector<glm::vec3> positions(n);
+    std::vector<unsigned> TTLs(n);
+    for (size_t i = 0; i < n; ++i) {
+        positions[i] = glm::vec3(space(rng), space(rng), space(rng));
+        TTLs[i] = TTL(rng);
+    }
+    std::vector<glm::vec3> expected = positions;
+
+    const ParticleTransform::Batch transform = ParticleTransform::combine(
+        ParticleTransform::buoyancy(glm::vec3(0, 0.1f, 0)), ParticleTransform::wind(glm::vec3(0.3f, 0, 0.2f), 5.f));
+    transform(expected.data(), TTLs.data(), n);
+    ParticleTransform::apply(transform, positions.data(), TTLs.data(), n);
+
+    size_t mismatch = 0;
+    for (size_t i = 0; i < n; ++i)
+        mismatch += positions[i] != expected[i];
+    CHECK(mismatch == 0);
+
+    // 很少的粒子直接在這個執行緒上處理，0個粒子也可以
+    ParticleTransform::apply(transform, positions.data(), TTLs.data(), 0);
+    ParticleTransform::apply(transform, positions.data(), TTLs.data(), 1);
+    transform(expected.data(), TTLs.data(), 1);
+    CHECK(positions[0] == expected[0]);
+}
+
+}
+
+int main()
+{
+    test_linear_drift_and_buoyancy();
+    test_wind();
+    test_combine_and_per_particle();
+    test_apply_parallel();
+    return Check::result();
+}
@@ -0,0 +1,187 @@
+/**
+ * @file test_ray_cast.cpp
+ * @brief RayCast 及 TriangleBVH 的單元測試：交點正確、BVH 和逐一檢查所有三角形一樣、打到控制點的box就選得到
+ */
+#include "Check.h"
+#include "RayCast.h"
+#include "ControlPointGrid.h"
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr float Inf = RayCast::No_Hit;
+
+glm::vec3 random_unit(std::mt19937& rng)
+{
+    std::normal_distribution<float> n(0.f, 1.f);
+    glm::vec3 v;
+    do {
+        v = glm::vec3(n(rng), n(rng), n(rng));
+    } while (glm::length(v) < 1.e-3f);
+    return glm::normalize(v);
+}
+
+void test_plane_y()
+{
+    CHECK_NEAR(RayCast::plane_y({ glm::vec3(0, 5, 0), glm::vec3(1, -2, 0) }, 1.f), 2.f, 1.e-6);
+    CHECK(RayCast::plane_y({ glm::vec3(0, 5, 0), glm::vec3(1, 0, 0) }, 1.f) == Inf);  // 平行
+    CHECK(RayCast::plane_y({ glm::vec3(0, 5, 0), glm::vec3(0, 1, 0) }, 1.f) == Inf);  // 在後方
+    CHECK(RayCast::plane_y({ glm::vec3(0, 1, 0), glm::vec3(0, -1, 0) }, 1.f) == 0.f); // 起點在平面上
+}
+
+void test_box()
+{
+    const glm::vec3 min(-1, -2, -3), max(1, 2, 3);
+    CHECK_NEAR(RayCast::box({ glm::vec3(-5, 0, 0), glm::vec3(2, 0, 0) }, min, max), 2.f, 1.e-6);
+    CHECK_NEAR(RayCast::box({ glm::vec3(0, 10, 0), glm::vec3(0, -1, 0) }, min, max), 8.f, 1.e-6);
+    CHECK(RayCast::box({ glm::vec3(0, 0, 0), glm::vec3(1, 1, 1) }, min, max) == 0.f);   // 起點在box內
+    CHECK(RayCast::box({ glm::vec3(-5, 0, 0), glm::vec3(-1, 0, 0) }, min, max) == Inf); // 在後方
+    CHECK(RayCast::box({ glm::vec3(-5, 3, 0), glm::vec3(1, 0, 0) }, min, max) == Inf);  // 平行，在slab外
+    CHECK(RayCast::box({ glm::vec3(-5, 0, 4), glm::vec3(1, 0, -0.1f) }, min, max) == Inf);
+
+    // 擦過邊界也算打到
+    CHECK_NEAR(RayCast::box({ glm::vec3(-5, 2, 0), glm::vec3(1, 0, 0) }, min, max), 4.f, 1.e-6);
+    CHECK_NEAR(RayCast::box({ glm::vec3(-2, 3, 4), glm::vec3(1, -1, -1) }, min, max), 1.f, 1.e-6); // 角 (-1, 2, 3)
+}
+
+void test_triangle()
+{
+    const glm::vec3 a(0, 0, 0), b(2, 0, 0), c(0, 2, 0);
+    CHECK_NEAR(RayCast::triangle({ glm::vec3(0.5f, 0.5f, 3), glm::vec3(0, 0, -1) }, a, b, c), 3.f, 1.e-6);
+    CHECK_NEAR(RayCast::triangle({ glm::vec3(0.5f, 0.5f, -3), glm::vec3(0, 0, 2) }, a, b, c), 1.5f, 1.e-6); // 背面
+    CHECK(RayCast::triangle({ glm::vec3(1.5f, 1.5f, 3), glm::vec3(0, 0, -1) }, a, b, c) == Inf); // 斜邊外
+    CHECK(RayCast::triangle({ glm::vec3(-0.1f, 0.5f, 3), glm::vec3(0, 0, -1) }, a, b, c) == Inf);
+    CHECK(RayCast::triangle({ glm::vec3(0.5f, 0.5f, 3), glm::vec3(0, 0, 1) }, a, b, c) == Inf);  // 在後方
+    CHECK(RayCast::triangle({ glm::vec3(0.5f, 0.5f, 3), glm::vec3(1, 0, 0) }, a, b, c) == Inf);  // 平行
+}
+
+/// 轉成軸對齊的box後，append_box() 的三角形和 RayCast::box() 打到的位置相同
+void test_append_box()
+{
+    std::vector<glm::vec3> triangles;
+    const glm::vec3 center(1, 2, 3), half(0.5f, 1.f, 2.f);
+    RayCast::append_box(triangles, center, glm::vec3(half.x, 0, 0), glm::vec3(0, half.y, 0), glm::vec3(0, 0, half.z));
+    CHECK(triangles.size() == 36);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> offset(-3.f, 3.f);
+    int hit = 0, mismatch = 0;
+    for (int k = 0; k < 2000; ++k) {
+        // 從box外射向box附近的點
+        const glm::vec3 origin = center + 8.f * random_unit(rng);
+        const glm::vec3 target = center + glm::vec3(offset(rng), offset(rng), offset(rng));
+        const Ray ray{ origin, target - origin };
+
+        float t = Inf;
+        for (size_t i = 0; i < triangles.size(); i += 3)
+            t = std::min(t, RayCast::triangle(ray, triangles[i], triangles[i + 1], triangles[i + 2]));
+        const float expected = RayCast::box(ray, center - half, center + half);
+        hit += expected != Inf;
+        mismatch += (t == Inf) != (expected == Inf) || (t != Inf && std::abs(t - expected) > 1.e-4f);
+    }
+    CHECK(hit > 200);
+    CHECK(mismatch <= 2); // 剛好擦過邊或角時可能不一樣
+}
+
+/// 逐一檢查所有三角形
+float brute_force(const std::vector<glm::vec3>& triangles, const Ray& ray)
+{
+    float best = Inf;
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+        best = std::min(best, RayCast::triangle(ray, triangles[i], triangles[i + 1], triangles[i + 2]));
+    return best;
+}
+
+void test_bvh()
+{
+    CHECK(TriangleBVH().intersect({ glm::vec3(0), glm::vec3(1, 0, 0) }) == Inf);
+    CHECK(TriangleBVH(std::vector<glm::vec3>(2)).triangle_num() == 0); // 不足一個三角形的點被丟掉
+
+    // 散在空間中的小三角形，包括數量不是 Leaf_Size 倍數的情況
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> space(-10.f, 10.f), small(-0.8f, 0.8f);
+    for (size_t num : { size_t(1), size_t(7), size_t(3001) }) {
+        std::vector<glm::vec3> triangles;
+        for (size_t i = 0; i < num; ++i) {
+            const glm::vec3 center(space(rng), space(rng), space(rng));
+            for (int k = 0; k < 3; ++k)
+                triangles.push_back(center + glm::vec3(small(rng), small(rng), small(rng)));
+        }
+        const TriangleBVH bvh(triangles);
+        CHECK(bvh.triangle_num() == num);
+
+        int hit = 0, mismatch = 0;
+        for (int k = 0; k < 3000; ++k) {
+            // 一半射向某個三角形，一半隨便射
+            const glm::vec3 origin = 15.f * random_unit(rng);
+            const glm::vec3 target = (k % 2 == 0) ? triangles[3 * (k % num)] : glm::vec3(space(rng), space(rng), space(rng));
+            const Ray ray{ origin, target - origin };
+
+            const float expected = brute_force(triangles, ray);
+            const float t = bvh.intersect(ray);
+            hit += expected != Inf;
+            mismatch += t != expected;
+        }
+        CHECK(hit > 0);
+        CHECK(mismatch == 0);
+    }
+}
+
+/// 同 TrainSystem：控制點的box，及選取時往外多留的誤差
+constexpr float CP_Size = 0.2f;
+const glm::vec3 CP_Box_Lower(CP_Size, CP_Size, CP_Size);
+const glm::vec3 CP_Box_Upper(CP_Size, 3 * CP_Size, CP_Size);
+constexpr float CP_Pick_Epsilon = 0.01f * CP_Size;
+
+/// 射線打到控制點的box時，交點一定選得到控制點（包括box的角和頂端）
+void test_hit_is_picked()
+{
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<float> xz(-20.f, 20.f), y(-1.f, 3.f), unit(0.f, 1.f);
+    std::vector<ControlPoint> control_points(40);
+    for (ControlPoint& cp : control_points)
+        cp = { glm::vec3(xz(rng), y(rng), xz(rng)), glm::vec3(0, 1, 0) };
+    ControlPointGrid grid(4 * CP_Size);
+    grid.rebuild(control_points);
+
+    int hit = 0, missed = 0;
+    for (int k = 0; k < 20000; ++k) {
+        // 射向box的角、邊或面上的點（每個座標有一半的機率剛好在邊界上）
+        const glm::vec3& p = control_points[k % control_points.size()].pos;
+        glm::vec3 target;
+        for (int a = 0; a < 3; ++a) {
+            const float lo = p[a] - CP_Box_Lower[a], hi = p[a] + CP_Box_Upper[a];
+            const float r = unit(rng);
+            target[a] = r < 0.25f ? lo : (r < 0.5f ? hi : lo + (hi - lo) * unit(rng));
+        }
+        const glm::vec3 origin = target + 60.f * random_unit(rng);
+        const Ray ray{ origin, 2.f * (target - origin) };
+
+        float t = Inf;
+        for (const ControlPoint& cp : control_points)
+            t = std::min(t, RayCast::box(ray, cp.pos - CP_Box_Lower, cp.pos + CP_Box_Upper));
+        if (t == Inf)
+            continue;
+        ++hit;
+
+        const glm::vec3 epsilon(CP_Pick_Epsilon);
+        missed += grid.pick(ray.origin + t * ray.dir, CP_Box_Lower + epsilon, CP_Box_Upper + epsilon) < 0;
+    }
+    CHECK(hit > 1000);
+    CHECK(missed == 0);
+}
+
+}
+
+int main()
+{
+    test_plane_y();
+    test_box();
+    test_triangle();
+    test_append_box();
+    test_bvh();
+    test_hit_is_picked();
+    return Check::result();
+}
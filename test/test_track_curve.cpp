@@ -0,0 +1,128 @@
+/**
+ * @file test_track_curve.cpp
+ * @brief TrackCurve 的單元測試：只重算受影響曲線的修改，結果須和整個重建一樣
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include <random>
+
+namespace {
+
+bool same_segment(const Draw::Cubic_Segment& a, const Draw::Cubic_Segment& b)
+{
+    return a.c0 == b.c0 && a.c1 == b.c1 && a.c2 == b.c2 && a.c3 == b.c3;
+}
+
+/// incremental 是一路修改過來的，和用同樣控制點整個重建的 TrackCurve 比較
+void check_same_as_rebuild(const TrackCurve& incremental, const std::vector<ControlPoint>& control_points, SplineType type)
+{
+    TrackCurve full;
+    full.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+    CHECK(incremental.segment_num() == full.segment_num());
+    if (incremental.segment_num() != full.segment_num())
+        return;
+
+    int segment_mismatch = 0;
+    for (size_t i = 0; i < full.segment_num(); ++i) {
+        segment_mismatch += !same_segment(incremental.pos_segment(i), full.pos_segment(i));
+        segment_mismatch += !same_segment(incremental.orient_segment(i), full.orient_segment(i));
+    }
+    CHECK(segment_mismatch == 0);
+
+    const ArcLenAccum& a = incremental.arc_len_accum();
+    const ArcLenAccum& b = full.arc_len_accum();
+    CHECK(a.segment_samples() == b.segment_samples());
+    CHECK(a.table().size() == b.table().size());
+    if (a.table().size() != b.table().size())
+        return;
+
+    double max_error = 0;
+    for (size_t k = 0; k < a.table().size(); ++k) {
+        max_error = std::max(max_error, double(std::abs(a.table()[k].first - b.table()[k].first)));
+        max_error = std::max(max_error, double(std::abs(a.table()[k].second - b.table()[k].second)));
+    }
+    CHECK_NEAR(max_error, 0., 1.e-5 * b.max_S());
+    CHECK_NEAR(incremental.length(), full.length(), 1.e-5 * full.length());
+}
+
+void test_incremental_edits()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        std::vector<ControlPoint> control_points = TestTrack::wavy(24, 7);
+        TrackCurve track;
+        track.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+        std::mt19937 rng(8);
+        std::uniform_real_distribution<float> offset(-1.f, 1.f);
+        for (int step = 0; step < 60; ++step) {
+            const size_t n = control_points.size();
+            std::uniform_int_distribution<size_t> pick(0, n - 1);
+            const size_t cp_id = pick(rng);
+            const size_t revision = track.revision();
+
+            switch (step % 3) {
+            case 0: // 移動，包括第0個和最後一個（會影響wrap的曲線）
+                control_points[cp_id].pos += glm::vec3(offset(rng), offset(rng), offset(rng));
+                track.update_control_point(control_points, cp_id, type, TestTrack::Tension, TestTrack::Tolerance);
+                break;
+            case 1: { // 插入在 cp_id 和 cp_id + 1 中間
+                ControlPoint cp = control_points[cp_id];
+                cp.pos = 0.5f * (cp.pos + control_points[(cp_id + 1) % n].pos) + glm::vec3(0, offset(rng), 0);
+                control_points.insert(control_points.begin() + cp_id + 1, cp);
+                track.insert_control_point(control_points, cp_id + 1, type, TestTrack::Tension, TestTrack::Tolerance);
+                break;
+            }
+            case 2: // 刪除
+                control_points.erase(control_points.begin() + cp_id);
+                track.erase_control_point(control_points, cp_id, type, TestTrack::Tension, TestTrack::Tolerance);
+                break;
+            }
+
+            CHECK(track.revision() != revision);
+            check_same_as_rebuild(track, control_points, type);
+        }
+    }
+}
+
+/// 用已經算好的區域表重建，結果須和積分的一樣
+void test_rebuild_from_tables()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        const auto control_points = TestTrack::wavy(16, 9);
+        TrackCurve integrated;
+        integrated.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+        TrackCurve loaded;
+        loaded.rebuild(control_points, type, TestTrack::Tension, integrated.arc_len_accum().segment_tables());
+        CHECK(loaded.arc_len_accum().table() == integrated.arc_len_accum().table());
+    }
+}
+
+/// 曲線須通過（或對 B-spline 而言接近）控制點，且相鄰兩段在接點連續
+void test_continuity()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        const auto control_points = TestTrack::wavy(12, 10);
+        TrackCurve track;
+        track.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+        for (size_t i = 0; i < track.segment_num(); ++i) {
+            const size_t next = (i + 1) % track.segment_num();
+            const glm::vec3 end = track.pos_segment(i)(1.f), start = track.pos_segment(next)(0.f);
+            CHECK_NEAR(glm::length(end - start), 0., 1.e-4);
+            if (type != SplineType::CUBIC_B)
+                CHECK_NEAR(glm::length(track.point_at(float(i)) - control_points[i].pos), 0., 1.e-5);
+        }
+    }
+}
+
+}
+
+int main()
+{
+    test_incremental_edits();
+    test_rebuild_from_tables();
+    test_continuity();
+    return Check::result();
+}
@@ -0,0 +1,245 @@
+/**
+ * @file test_track_io.cpp
+ * @brief TrackIO 的單元測試：文字和二進位格式寫入後讀回相同，格式錯誤時丟出例外
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include "TrackIO.h"
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+bool same_control_points(const std::vector<ControlPoint>& a, const std::vector<ControlPoint>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].pos != b[i].pos || a[i].orient != b[i].orient)
+            return false;
+    }
+    return true;
+}
+
+/// 用 read_text() 和 parse_text() 各讀一次，兩者須一樣
+std::vector<ControlPoint> read_text(const std::string& text)
+{
+    std::istringstream in(text);
+    std::vector<ControlPoint> from_stream = TrackIO::read_text(in);
+    const std::vector<ControlPoint> from_buffer = TrackIO::parse_text(text.data(), text.size());
+    CHECK(same_control_points(from_stream, from_buffer));
+    return from_stream;
+}
+
+std::string write_binary(const std::vector<ControlPoint>& control_points, const TrackCurve* track, SplineType type)
+{
+    std::ostringstream out;
+    TrackIO::write_binary(out, control_points, track ? &track->arc_len_accum() : nullptr,
+                          type, TestTrack::Tension, TestTrack::Tolerance);
+    return out.str();
+}
+
+TrackIO::Track_Data parse_binary(const std::string& bytes)
+{
+    return TrackIO::parse_binary(bytes.data(), bytes.size());
+}
+
+void test_text_round_trip()
+{
+    const auto control_points = TestTrack::wavy(100, 15);
+    std::ostringstream out;
+    TrackIO::write_text(out, control_points);
+    CHECK(same_control_points(read_text(out.str()), control_points));
+    CHECK(!TrackIO::is_binary(out.str().data(), out.str().size()));
+
+    // 比 Text_Chunk_Size 大很多，數字會跨過緩衝區的邊界
+    const auto many = TestTrack::wavy(100000, 16);
+    std::ostringstream big;
+    TrackIO::write_text(big, many);
+    CHECK(big.str().size() > 2 * TrackIO::Text_Chunk_Size);
+    CHECK(same_control_points(read_text(big.str()), many));
+
+    CHECK(read_text("0").empty());
+}
+
+/// 手寫的文字檔：任何空白都可以當分隔，檔尾沒有換行也可以
+void test_text_whitespace()
+{
+    const auto control_points = read_text("2\r\n1 2 3\t4 5 6\n\n  -1e1 0.5 .25 0 1 0");
+    CHECK(control_points.size() == 2);
+    if (control_points.size() == 2) {
+        CHECK(control_points[0].pos == glm::vec3(1, 2, 3));
+        CHECK(control_points[0].orient == glm::vec3(4, 5, 6));
+        CHECK(control_points[1].pos == glm::vec3(-10, 0.5f, 0.25f));
+        CHECK(control_points[1].orient == glm::vec3(0, 1, 0));
+    }
+
+    // 和原本用iostream讀時一樣，接受開頭的 '+'；個數可以寫成浮點數，但須為整數
+    const auto signed_values = read_text("+1 +1.5 -2 +3e1 0 +1 0");
+    CHECK(signed_values.size() == 1);
+    if (signed_values.size() == 1) {
+        CHECK(signed_values[0].pos == glm::vec3(1.5f, -2, 30));
+        CHECK(signed_values[0].orient == glm::vec3(0, 1, 0));
+    }
+    CHECK(read_text("4.0\n0 0 0 0 1 0 1 0 0 0 1 0 1 0 1 0 1 0 0 0 1 0 1 0").size() == 4);
+}
+
+void test_text_malformed()
+{
+    CHECK_THROWS(read_text(""), std::runtime_error);
+    CHECK_THROWS(read_text("-1"), std::runtime_error);
+    CHECK_THROWS(read_text("abc"), std::runtime_error);
+    CHECK_THROWS(read_text("2\n1 2 3 4 5 6\n1 2 3"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 3 4 5 6x"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 3 4 5 --6"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 3 4 5 +-6"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 3 4 5 ++6"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 inf 4 5 6"), std::runtime_error);
+    CHECK_THROWS(read_text("1\n1 2 nan 4 5 6"), std::runtime_error);
+    CHECK_THROWS(read_text("4.5\n1 2 3 4 5 6"), std::runtime_error);
+    CHECK_THROWS(read_text("1e30\n1 2 3 4 5 6"), std::runtime_error);
+    // 個數很大但資料很少：不會先配置那麼多記憶體，而是讀到一半發現不夠
+    CHECK_THROWS(read_text("4000000000\n1 2 3 4 5 6"), std::runtime_error);
+}
+
+void test_binary_round_trip()
+{
+    for (SplineType type : TestTrack::Spline_Types) {
+        const auto control_points = TestTrack::wavy(32, 17);
+        TrackCurve track;
+        track.rebuild(control_points, type, TestTrack::Tension, TestTrack::Tolerance);
+
+        const std::string bytes = write_binary(control_points, &track, type);
+        CHECK(TrackIO::is_binary(bytes.data(), bytes.size()));
+
+        const TrackIO::Track_Data data = parse_binary(bytes);
+        CHECK(same_control_points(data.control_points, control_points));
+        CHECK(data.has_arc_len_table);
+        CHECK(data.table_matches(type, TestTrack::Tension, TestTrack::Tolerance));
+        CHECK(!data.table_matches(type, TestTrack::Tension, 2 * TestTrack::Tolerance));
+        CHECK(data.tables == track.arc_len_accum().segment_tables());
+
+        // 用讀回的區域表重建，結果須和積分的一樣
+        TrackCurve loaded;
+        loaded.rebuild(data.control_points, data.type, data.tension, data.tables);
+        CHECK(loaded.arc_len_accum().table() == track.arc_len_accum().table());
+    }
+
+    // 沒有曲線長累積表
+    const auto control_points = TestTrack::square();
+    const TrackIO::Track_Data data = parse_binary(write_binary(control_points, nullptr, SplineType::LINEAR));
+    CHECK(same_control_points(data.control_points, control_points));
+    CHECK(!data.has_arc_len_table);
+    CHECK(!data.table_matches(SplineType::LINEAR, TestTrack::Tension, TestTrack::Tolerance));
+}
+
+void test_binary_malformed()
+{
+    const auto control_points = TestTrack::wavy(8, 18);
+    TrackCurve track;
+    track.rebuild(control_points, SplineType::CARDINAL, TestTrack::Tension, TestTrack::Tolerance);
+    const std::string good = write_binary(control_points, &track, SplineType::CARDINAL);
+    CHECK(parse_binary(good).control_points.size() == control_points.size());
+
+    const size_t cp_end = sizeof(TrackIO::Binary_Header) + control_points.size() * sizeof(ControlPoint);
+    const size_t samples_end = cp_end + control_points.size() * sizeof(uint32_t);
+
+    auto header_of = [](std::string& bytes) {
+        TrackIO::Binary_Header header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        return header;
+    };
+    auto set_header = [](std::string& bytes, const TrackIO::Binary_Header& header) {
+        std::memcpy(&bytes[0], &header, sizeof(header));
+    };
+    auto set_float = [](std::string& bytes, size_t offset, float value) {
+        std::memcpy(&bytes[offset], &value, sizeof(value));
+    };
+
+    // 檔頭不完整或magic不對
+    CHECK_THROWS(parse_binary(good.substr(0, sizeof(TrackIO::Binary_Header) - 1)), std::runtime_error);
+    {
+        std::string bytes = good;
+        bytes[0] = 'X';
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 版本0和之後的版本
+    for (uint32_t version : { 0u, TrackIO::Binary_Version + 1 }) {
+        std::string bytes = good;
+        TrackIO::Binary_Header header = header_of(bytes);
+        header.version = version;
+        set_header(bytes, header);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 控制點或區域表被截斷
+    CHECK_THROWS(parse_binary(good.substr(0, cp_end - 1)), std::runtime_error);
+    CHECK_THROWS(parse_binary(good.substr(0, good.size() - 1)), std::runtime_error);
+    // 控制點個數大到相乘會溢位
+    {
+        std::string bytes = good;
+        TrackIO::Binary_Header header = header_of(bytes);
+        header.cp_num = 0xffffffffu;
+        set_header(bytes, header);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 每段的項數加起來和 table_entries 不符
+    {
+        std::string bytes = good;
+        uint32_t samples;
+        std::memcpy(&samples, &bytes[cp_end], sizeof(samples));
+        --samples;
+        std::memcpy(&bytes[cp_end], &samples, sizeof(samples));
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 區域表的 t 沒有遞增
+    {
+        std::string bytes = good;
+        set_float(bytes, samples_end + 2 * sizeof(float), 0.f);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 第0段區域表的最後一項的 t 不是1，或第一項的 t 不大於0
+    const size_t last = samples_end + (track.arc_len_accum().segment_samples()[0] - 1) * 2 * sizeof(float);
+    {
+        std::string bytes = good;
+        set_float(bytes, last, 0.999f);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    {
+        std::string bytes = good;
+        set_float(bytes, samples_end, 0.f);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // s 為負、遞減、NaN或無限大
+    const float bad_s[] = {
+        -0.5f,                                     // 第一項為負
+        0.f,                                       // 第二項比第一項小（第一項原本大於0）
+        std::numeric_limits<float>::quiet_NaN(),   // 第一項
+        std::numeric_limits<float>::infinity(),    // 第一項
+    };
+    for (int k = 0; k < 4; ++k) {
+        std::string bytes = good;
+        set_float(bytes, samples_end + (k == 1 ? 3 : 1) * sizeof(float), bad_s[k]);
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+    // 最後一項的 s 為無限大
+    {
+        std::string bytes = good;
+        set_float(bytes, last + sizeof(float), std::numeric_limits<float>::infinity());
+        CHECK_THROWS(parse_binary(bytes), std::runtime_error);
+    }
+}
+
+}
+
+int main()
+{
+    test_text_round_trip();
+    test_text_whitespace();
+    test_text_malformed();
+    test_binary_round_trip();
+    test_binary_malformed();
+    return Check::result();
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_train_fleet.cpp
+ * @brief TrainFleet 的單元測試：前進、wrap、不會追撞、維持排序
+ */
+#include "Check.h"
+#include "TrainFleet.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr float Cart_Spacing = 0.5f;
+constexpr float Min_Gap = 0.25f;
+constexpr float Length = 40.f;
+
+/// 第i列火車的車頭到前車車尾的距離
+float gap(const TrainFleet& fleet, size_t i, float length)
+{
+    const size_t front = (i + 1) % fleet.size();
+    const float front_S = (front == 0) ? fleet.S(0) + length : fleet.S(front);
+    return front_S - fleet.train_length(front) - fleet.S(i);
+}
+
+void test_add_and_find()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    const int a = fleet.add(10.f, 1.f, 2);
+    const int b = fleet.add(2.f, 1.f, 3);
+    const int c = fleet.add(30.f, 1.f, 1);
+    CHECK(fleet.size() == 3);
+    CHECK(a != b && b != c && a != c);
+
+    // 依照S排序
+    CHECK(fleet.id(0) == b && fleet.id(1) == a && fleet.id(2) == c);
+    CHECK(fleet.find(a) == 1);
+    CHECK(fleet.find(12345) == fleet.size());
+    CHECK_NEAR(fleet.train_length(fleet.find(b)), 4 * Cart_Spacing, 1.e-6);
+
+    fleet.remove(fleet.find(a));
+    CHECK(fleet.size() == 2);
+    CHECK(fleet.find(a) == fleet.size());
+    fleet.clear();
+    CHECK(fleet.size() == 0);
+}
+
+/// 單獨一列火車：照速度倍率前進，超過終點時wrap
+void test_single_train()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    fleet.add(Length - 1.f, 2.f, 3);
+    fleet.advance(1.5f, Length);
+    CHECK_NEAR(fleet.S(0), 2.f, 1.e-4);
+    CHECK_NEAR(fleet.moved(0), 3.f, 1.e-4);
+
+    fleet.advance(0.f, Length);
+    CHECK_NEAR(fleet.moved(0), 0.f, 1.e-6);
+}
+
+/// 後車比較快時會停在前車車尾後 min_gap 處，且不會後退
+void test_no_collision()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    const int slow = fleet.add(10.f, 0.5f, 3);
+    const int fast = fleet.add(5.f, 3.f, 3);
+
+    for (int step = 0; step < 200; ++step) {
+        fleet.advance(0.1f, Length);
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            CHECK(gap(fleet, i, Length) >= Min_Gap - 1.e-3f);
+            CHECK(fleet.moved(i) >= 0.f);
+        }
+    }
+    // 快車已經追上，現在和慢車一樣快
+    CHECK_NEAR(fleet.moved(fleet.find(fast)), fleet.moved(fleet.find(slow)), 1.e-4);
+    CHECK_NEAR(gap(fleet, fleet.find(fast), Length), Min_Gap, 1.e-3);
+}
+
+/// 很多列火車、各種速度跑很多圈：維持排序、順序（不會超車）和間距
+void test_many_trains()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    std::mt19937 rng(14);
+    std::uniform_real_distribution<float> speed(0.2f, 3.f);
+    for (int k = 0; k < 8; ++k)
+        fleet.add(k * 5.f + 3.f, speed(rng), 1 + k % 4);
+
+    std::vector<int> initial_order;
+    for (size_t i = 0; i < fleet.size(); ++i)
+        initial_order.push_back(fleet.id(i));
+
+    bool sorted = true, order_kept = true, gaps_kept = true, in_range = true;
+    for (int step = 0; step < 2000; ++step) {
+        fleet.advance(0.37f, Length);
+
+        std::vector<int> order;
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            order.push_back(fleet.id(i));
+            in_range = in_range && fleet.S(i) >= 0.f && fleet.S(i) < Length;
+            gaps_kept = gaps_kept && gap(fleet, i, Length) >= Min_Gap - 1.e-3f;
+            sorted = sorted && (i == 0 || fleet.S(i - 1) <= fleet.S(i));
+        }
+        // 繞圈的順序不變，只是起點不同
+        auto first = std::find(order.begin(), order.end(), initial_order[0]);
+        std::rotate(order.begin(), first, order.end());
+        order_kept = order_kept && order == initial_order;
+    }
+    CHECK(sorted);
+    CHECK(order_kept);
+    CHECK(gaps_kept);
+    CHECK(in_range);
+}
+
+void test_rescale()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    fleet.add(10.f, 1.f, 1);
+    fleet.add(30.f, 1.f, 1);
+    fleet.advance(1.f, Length);
+
+    fleet.rescale(0.5f, Length / 2);
+    CHECK_NEAR(fleet.S(0), 5.5f, 1.e-4);
+    CHECK_NEAR(fleet.S(1), 15.5f, 1.e-4);
+    CHECK(fleet.moved(0) == 0.f && fleet.moved(1) == 0.f);
+}
+
+void test_largest_gap_center()
+{
+    TrainFleet fleet(Cart_Spacing, Min_Gap);
+    CHECK(fleet.largest_gap_center(Length) == 0.f);
+
+    // 車頭在 10 和 20，各長 1：空隙為 10 ~ 19 和 20 ~ 49（繞過終點），後者的中間為 34.5
+    fleet.add(10.f, 1.f, 1);
+    fleet.add(20.f, 1.f, 1);
+    CHECK_NEAR(fleet.largest_gap_center(Length), 34.5f, 1.e-4);
+
+    // 車頭在 30 和 35：最大的空隙為 35 ~ 69，中間為 52 → wrap 回 12
+    fleet.clear();
+    fleet.add(30.f, 1.f, 1);
+    fleet.add(35.f, 1.f, 1);
+    CHECK_NEAR(fleet.largest_gap_center(Length), 12.f, 1.e-4);
+}
+
+}
+
+int main()
+{
+    test_add_and_find();
+    test_single_train();
+    test_no_collision();
+    test_many_trains();
+    test_rescale();
+    test_largest_gap_center();
+    return Check::result();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file test_train_simulation.cpp
+ * @brief TrainSimulation 的單元測試：advance_time() 的步數、補步的上限、內插比例、thread
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include "TrainSimulation.h"
+#include <memory>
+#include <thread>
+
+namespace {
+
+constexpr float Step_Seconds = 0.01f;
+constexpr float Distance_Per_Step = 0.1f;
+constexpr float Length = 100.f;
+
+TrainFleet one_train(float speed)
+{
+    TrainFleet fleet(0.5f, 0.25f);
+    fleet.add(0.f, speed, 2);
+    return fleet;
+}
+
+/// TrainSimulation 不能複製或移動，所以用 unique_ptr 傳回
+std::unique_ptr<TrainSimulation> make_simulation(float speed)
+{
+    std::unique_ptr<TrainSimulation> sim(new TrainSimulation(one_train(speed), Step_Seconds));
+    sim->set_track_length(Length);
+    sim->set_distance_per_step(Distance_Per_Step);
+    return sim;
+}
+
+void test_advance_time()
+{
+    auto sim = make_simulation(2.f);
+    TrainFleet fleet(0.f, 0.f);
+    size_t steps = 0;
+
+    // 不到一步時不動，內插比例為累積的時間
+    sim->advance_time(0.4f * Step_Seconds);
+    CHECK_NEAR(sim->snapshot(fleet, steps), 0.4, 1.e-4);
+    CHECK(steps == 0);
+    CHECK(fleet.S(0) == 0.f);
+
+    // 累積到第3步：之前的0.4步加上2.8步
+    sim->advance_time(2.8f * Step_Seconds);
+    CHECK_NEAR(sim->snapshot(fleet, steps), 0.2, 1.e-3);
+    CHECK(steps == 3);
+    CHECK_NEAR(fleet.S(0), 3 * 2.f * Distance_Per_Step, 1.e-5);
+    CHECK_NEAR(fleet.moved(0), 2.f * Distance_Per_Step, 1.e-5);
+}
+
+/// 一次經過太久時最多補 Max_Catch_Up_Steps 步，多的時間丟掉
+void test_catch_up_limit()
+{
+    auto sim = make_simulation(1.f);
+    TrainFleet fleet(0.f, 0.f);
+    size_t steps = 0;
+
+    sim->advance_time(100 * Step_Seconds);
+    const float alpha = sim->snapshot(fleet, steps);
+    CHECK(steps == TrainSimulation::Max_Catch_Up_Steps);
+    CHECK_NEAR(fleet.S(0), TrainSimulation::Max_Catch_Up_Steps * Distance_Per_Step, 1.e-4);
+    CHECK(alpha <= 1.f);
+
+    // 丟掉的時間不會在之後補回來
+    sim->advance_time(0.f);
+    sim->snapshot(fleet, steps);
+    CHECK(steps <= TrainSimulation::Max_Catch_Up_Steps + 1);
+}
+
+/// 軌道長度改變時依比例調整位置
+void test_track_length()
+{
+    auto sim = make_simulation(1.f);
+    sim->advance_time(5 * Step_Seconds + 1.e-6f);
+    sim->set_track_length(2 * Length);
+
+    TrainFleet fleet(0.f, 0.f);
+    size_t steps = 0;
+    sim->snapshot(fleet, steps);
+    CHECK_NEAR(fleet.S(0), 2 * 5 * Distance_Per_Step, 1.e-4);
+}
+
+/// 有速度表時依所在位置查表：平坦的軌道上，摩擦讓速度一直停在 lift 的速度
+void test_velocity_profile()
+{
+    TrackCurve track;
+    track.rebuild(TestTrack::square(), SplineType::LINEAR, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(0.05f);
+    frames.rebuild(track);
+    auto profile = std::make_shared<VelocityProfile>(0.05f, 9.8f, 0.05f, 2.f, 20.f);
+    profile->rebuild(frames);
+
+    TrainSimulation sim(one_train(1.f), Step_Seconds);
+    sim.set_track_length(track.length());
+    sim.set_velocity_profile(profile);
+    sim.advance_time(4 * Step_Seconds + 1.e-6f);
+
+    TrainFleet fleet(0.f, 0.f);
+    size_t steps = 0;
+    sim.snapshot(fleet, steps);
+    CHECK(steps == 4);
+    CHECK_NEAR(fleet.S(0), 4 * 2.f * Step_Seconds, 1.e-4);
+
+    // 速度倍率在物理模式下也有效
+    TrainSimulation fast(one_train(3.f), Step_Seconds);
+    fast.set_track_length(track.length());
+    fast.set_velocity_profile(profile);
+    fast.advance_time(4 * Step_Seconds + 1.e-6f);
+    fast.snapshot(fleet, steps);
+    CHECK_NEAR(fleet.S(0), 3 * 4 * 2.f * Step_Seconds, 1.e-4);
+}
+
+/// 開thread後自己會前進，stop() 後就不再前進
+void test_thread()
+{
+    auto sim = make_simulation(1.f);
+    sim->start();
+    std::this_thread::sleep_for(std::chrono::duration<float>(20 * Step_Seconds));
+    sim->stop();
+
+    TrainFleet fleet(0.f, 0.f);
+    size_t steps = 0;
+    sim->snapshot(fleet, steps);
+    CHECK(steps > 0);
+    CHECK_NEAR(fleet.S(0), steps * Distance_Per_Step, 1.e-3);
+
+    std::this_thread::sleep_for(std::chrono::duration<float>(5 * Step_Seconds));
+    size_t after = 0;
+    sim->snapshot(fleet, after);
+    CHECK(after == steps);
+}
+
+}
+
+int main()
+{
+    test_advance_time();
+    test_catch_up_limit();
+    test_track_length();
+    test_velocity_profile();
+    test_thread();
+    return Check::result();
+}
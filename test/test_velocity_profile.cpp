@@ -0,0 +1,93 @@
+/**
+ * @file test_velocity_profile.cpp
+ * @brief VelocityProfile 的單元測試：速度的範圍、能量守恆、起點連續、一圈的時間
+ */
+#include "Check.h"
+#include "TestTrack.h"
+#include "FrameTable.h"
+#include "VelocityProfile.h"
+
+namespace {
+
+constexpr float Interval = 0.05f;
+constexpr float Gravity = 9.8f;
+constexpr float Lift_Speed = 1.f;
+constexpr float Max_Speed = 12.f;
+
+/// 平坦的軌道：摩擦讓速度一直停在lift的速度
+void test_flat()
+{
+    TrackCurve track;
+    track.rebuild(TestTrack::square(), SplineType::LINEAR, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(Interval);
+    frames.rebuild(track);
+
+    VelocityProfile profile(Interval, Gravity, 0.05f, Lift_Speed, Max_Speed);
+    CHECK(profile.empty());
+    profile.rebuild(frames);
+    CHECK(!profile.empty());
+
+    for (int k = 0; k < 100; ++k)
+        CHECK_NEAR(profile.at(track.length() * k / 100), Lift_Speed, 1.e-5);
+    CHECK_NEAR(profile.lap_time(), track.length() / Lift_Speed, 1.e-3 * track.length());
+}
+
+/// 上下起伏的軌道
+void test_hills()
+{
+    TrackCurve track;
+    track.rebuild(TestTrack::wavy(24, 20), SplineType::CARDINAL, TestTrack::Tension, TestTrack::Tolerance);
+    FrameTable frames(Interval);
+    frames.rebuild(track);
+
+    for (float friction : { 0.f, 0.02f }) {
+        VelocityProfile profile(Interval, Gravity, friction, Lift_Speed, Max_Speed);
+        profile.rebuild(frames);
+
+        bool in_range = true;
+        float max_jump = 0.f;
+        float prev = profile.at(-0.5f * Interval);
+        const int samples = static_cast<int>(track.length() / (0.5f * Interval));
+        for (int k = 0; k <= samples; ++k) {
+            const float v = profile.at(track.length() * k / samples);
+            in_range = in_range && v >= Lift_Speed - 1.e-4f && v <= Max_Speed + 1.e-4f;
+            max_jump = std::max(max_jump, std::abs(v - prev));
+            prev = v;
+        }
+        CHECK(in_range);
+        // 最大的變化來自 v^2 = 2g * dh，每半個間距不會跳太多；起點也不例外
+        CHECK(max_jump < 0.5f);
+        CHECK_NEAR(profile.at(0.f), profile.at(track.length() - 1.e-4f), 1.e-2);
+
+        // 沒有摩擦、沒碰到lift或煞車的地方，v^2 + 2g * h 不變
+        if (friction == 0.f) {
+            int violations = 0;
+            float energy = -1.f;
+            for (int k = 0; k <= samples; ++k) {
+                const float S = track.length() * k / samples;
+                const float v = profile.at(S);
+                if (v <= Lift_Speed + 1.e-3f || v >= Max_Speed - 1.e-3f) {
+                    energy = -1.f; // 碰到lift或煞車，能量重新算
+                    continue;
+                }
+                const float e = v * v + 2 * Gravity * frames.at(S).pos.y;
+                if (energy >= 0.f)
+                    violations += std::abs(e - energy) > 0.05f * energy;
+                energy = e;
+            }
+            CHECK(violations == 0);
+        }
+
+        CHECK(profile.lap_time() > track.length() / Max_Speed);
+        CHECK(profile.lap_time() < track.length() / Lift_Speed);
+    }
+}
+
+}
+
+int main()
+{
+    test_flat();
+    test_hills();
+    return Check::result();
+}